@@ -0,0 +1,66 @@
+#include <ioManager/ioManager.h>
+#include <ioManager/timer.h>
+
+// Round trips between this manager and a pool thread: post an empty task, await its async_future.
+// Both sides are woken across threads on every trip, once with plain suspends and once with busy polling.
+constexpr size_t ROUND_TRIPS = 20000;
+
+io::future_fsm_func_ round(const char* name, const io::busy_poll_options& options) {
+    io::fsm<io::future>& fsm = co_await io::get_fsm;
+    fsm.getManager()->set_busy_poll(options);
+    io::pool thread_pool(1, options);
+    auto local_before = fsm.getManager()->get_busy_poll_stats();
+
+    io::timer::up timer;
+    timer.start();
+    for (size_t i = 0; i < ROUND_TRIPS; i++)
+        co_await thread_pool.post(fsm.getManager(), []() {});
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(timer.lap());
+
+    auto local = fsm.getManager()->get_busy_poll_stats();
+    local.spinning -= local_before.spinning;
+    local.sleeping -= local_before.sleeping;
+    local.spin_wakes -= local_before.spin_wakes;
+    local.sleeps -= local_before.sleeps;
+    auto remote = thread_pool.get_busy_poll_stats();
+    std::cout << name << ":\n"
+        << "  average round trip: " << duration.count() / double(ROUND_TRIPS) << " ns\n";
+    if (options.max_spin.count())
+    {
+        for (auto& [side, st] : { std::make_pair("this thread", local), std::make_pair("pool thread", remote) })
+            std::cout << "  " << side << ": spinning " << std::chrono::duration_cast<std::chrono::microseconds>(st.spinning).count()
+                << " us, sleeping " << std::chrono::duration_cast<std::chrono::microseconds>(st.sleeping).count()
+                << " us, woken while spinning " << st.spin_wakes << ", slept " << st.sleeps
+                << ", spin budget " << st.spin_budget.count() << " ns\n";
+    }
+    fsm.getManager()->set_busy_poll({});
+    co_return;
+}
+
+io::fsm_func<void> busy_poll_benchmark() {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    io::busy_poll_options adaptive;
+    adaptive.max_spin = std::chrono::microseconds(50);
+    io::busy_poll_options fixed = adaptive;
+    fixed.adaptive = false;
+    std::cout << ROUND_TRIPS << " round trips\n";
+    while (1) {
+        co_await *fsm.spawn_now(round("suspend right away", {}));
+        co_await *fsm.spawn_now(round("busy poll, adaptive up to 50 us", adaptive));
+        co_await *fsm.spawn_now(round("busy poll, always 50 us", fixed));
+        std::cout << std::endl;
+    }
+}
+
+int main()
+{
+    io::manager mngr;
+    mngr.async_spawn(busy_poll_benchmark());
+
+    while (1)
+    {
+        mngr.drive();
+    }
+
+    return 0;
+}
@@ -7,6 +7,7 @@
 #include <ioManager/timer.h>
 
 io::fsm_func<void> stackful_benchmark();
+void resume_mode_benchmark(io::fsm<void>& fsm, std::vector<io::fsm_handle<io::promise<>>>& test_coros, size_t total_switches);
 
 io::fsm_func<void> benchmark()
 {
@@ -56,11 +57,62 @@ io::fsm_func<void> benchmark()
         << "Total switches: " << TOTAL_SWITCHES << "\n"
         << "Total time: " << duration_loop.count() / 1000.0 << " ms\n"
         << "Switches per second: " << static_cast<size_t>(switches_per_sec) << "\n"
-        << "Average switch time: " << duration_loop.count() / double(TOTAL_SWITCHES) * 1000.0 << " ns\n\n\n\n";
+        << "Average switch time: " << duration_loop.count() / double(TOTAL_SWITCHES) * 1000.0 << " ns\n\n";
+
+    resume_mode_benchmark(fsm, test_coros, TOTAL_SWITCHES);
+    std::cout << "\n\n";
 
     fsm.getManager()->spawn_later(stackful_benchmark()).detach();
 }
 
+// the switch loop again with a trampolined resume, then a chain: every coroutine resolves the next one when it's resumed.
+// Nested, the chain resumes CHAIN coroutines inside each other. Trampolined, they run one after another on a flat stack.
+void resume_mode_benchmark(io::fsm<void>& fsm, std::vector<io::fsm_handle<io::promise<>>>& test_coros, size_t total_switches)
+{
+    constexpr size_t CHAIN = 10000;
+    constexpr size_t CHAIN_RUNS = 100;
+
+    io::timer::up timer;
+    fsm.getManager()->set_resume_mode(io::resume_mode::trampolined);
+    timer.start();
+    for (size_t i = 0; i < total_switches; i++)
+    {
+        test_coros[i % test_coros.size()]->resolve();
+    }
+    auto duration_loop = std::chrono::duration_cast<std::chrono::microseconds>(timer.lap());
+    std::cout << "Trampolined resume:\n"
+        << "Average switch time: " << duration_loop.count() / double(total_switches) * 1000.0 << " ns\n\n";
+
+    std::vector<io::promise<void>> chain(CHAIN + 1);
+    std::vector<io::fsm_handle<void>> chain_coros;
+    for (size_t i = 0; i < CHAIN; i++)
+    {
+        chain_coros.push_back(
+            fsm.spawn_now([](std::vector<io::promise<void>>& chain, size_t i) -> io::fsm_func<void>
+                          {
+                    io::future future;
+                    while (1)
+                    {
+                        chain[i] = io::make_future(future);
+                        co_await future;
+                        chain[i + 1].resolve();
+                    } }(chain, i)));
+    }
+    for (auto mode : { io::resume_mode::nested, io::resume_mode::trampolined })
+    {
+        fsm.getManager()->set_resume_mode(mode);
+        timer.start();
+        for (size_t k = 0; k < CHAIN_RUNS; k++)
+        {
+            chain[0].resolve();
+        }
+        auto duration_chain = std::chrono::duration_cast<std::chrono::microseconds>(timer.lap());
+        std::cout << "Resolve chain of " << CHAIN << " coroutines, " << (mode == io::resume_mode::nested ? "nested" : "trampolined") << ":\n"
+            << "Average time per hop: " << duration_chain.count() / double(CHAIN * CHAIN_RUNS) * 1000.0 << " ns\n\n";
+    }
+    fsm.getManager()->set_resume_mode(io::resume_mode::nested);
+}
+
 io::fsm_func<void> stackful_benchmark()
 {
     constexpr size_t NUM_COROS = 3000;
@@ -115,7 +167,74 @@ io::fsm_func<void> stackful_benchmark()
               << "Total switches: " << NUM_COROS * ITERATION << "\n"
               << "Total time: " << duration_loop.count() / 1000.0 << " ms\n"
               << "Switches per second: " << static_cast<size_t>(switches_per_sec) << "\n"
-              << "Average switch time: " << duration_loop.count() / double(NUM_COROS * ITERATION) * 1000.0 << " ns\n\n\n\n";
+              << "Average switch time: " << duration_loop.count() / double(NUM_COROS * ITERATION) * 1000.0 << " ns\n\n";
+
+    // combinator: every coroutine awaits io::future::all of two futures, one switch per pair.
+    std::vector<io::promise<void>> second_promises;
+    second_promises.resize(NUM_COROS);
+    for (size_t i = 0; i < NUM_COROS; i++)
+    {
+        io::stackful::spawn_stacksize(1024, [i](std::vector<io::promise<void>> &promises, std::vector<io::promise<void>> &second_promises)
+                                      {
+                io::future first, second;
+                while (1)
+                {
+                    promises[i] = io::make_future(first);
+                    second_promises[i] = io::make_future(second);
+                    io::stackful::await(io::future::all(first, second));
+                    if (first.getErr())
+                        return;
+                } }, test_promises, second_promises);
+    }
+    timer.start();
+    for (size_t k = 0; k < ITERATION - 1; k++)
+    {
+        for (size_t i = 0; i < NUM_COROS; i++)
+        {
+            test_promises[i].resolve();
+            second_promises[i].resolve();
+        }
+    }
+    for (size_t i = 0; i < NUM_COROS; i++)
+    {
+        test_promises[i].reject(std::errc::operation_canceled);
+    }
+    auto duration_all = std::chrono::duration_cast<std::chrono::microseconds>(timer.lap());
+    std::cout << "Stackful await io::future::all(2 futures):\n"
+              << "Switches per second: " << static_cast<size_t>(NUM_COROS * ITERATION * 1000000.0 / duration_all.count()) << "\n"
+              << "Average switch time: " << duration_all.count() / double(NUM_COROS * ITERATION) * 1000.0 << " ns\n\n";
+    second_promises.clear();
+
+    // spawn and finish: short lived coroutines, each one is destroyed as soon as it returned.
+    // Without the pool only mmap'd stacks are compared: malloc would hand the same freed block back to the next spawn.
+    constexpr size_t SPAWNS = 100000;
+    io::stackful::stack_pool::options pooled;
+    io::stackful::stack_pool::options guarded_no_pool;
+    guarded_no_pool.guard_pages = true;
+    guarded_no_pool.max_cached_bytes = 0;
+    io::stackful::stack_pool::options guarded;
+    guarded.guard_pages = true;
+    std::pair<const char*, io::stackful::stack_pool::options> configs[] = {
+        { "stack pool", pooled }, { "no stack pool, guard pages", guarded_no_pool }, { "stack pool, guard pages", guarded } };
+    for (auto& [name, options] : configs)
+    {
+        io::stackful::stacks().set_options(options);
+        size_t reused = io::stackful::stacks().reused();
+        size_t finished = 0;
+        timer.start();
+        for (size_t i = 0; i < SPAWNS; i++)
+        {
+            io::stackful::spawn([](size_t &finished)
+                                { finished++; }, finished);
+        }
+        auto duration_spawn = std::chrono::duration_cast<std::chrono::microseconds>(timer.lap());
+        std::cout << "Stackful spawn and finish, " << name << ":\n"
+                  << "Spawn and finish per second: " << static_cast<size_t>(finished * 1000000.0 / duration_spawn.count()) << "\n"
+                  << "Average spawn and finish time: " << duration_spawn.count() / double(finished) * 1000.0 << " ns\n"
+                  << "Stacks reused: " << io::stackful::stacks().reused() - reused << "\n\n";
+    }
+    io::stackful::stacks().set_options({});
+    std::cout << "\n\n";
 
     fsm.getManager()->spawn_later(benchmark()).detach();
 }
@@ -0,0 +1,69 @@
+#include <ioManager/ioManager.h>
+#include <ioManager/timer.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// Memory per live future: LIVE futures are kept pending at once, like one read per connection and direction.
+// Every pending future holds an awaiter from the manager's hive, the heap grows by LIVE awaiters.
+// Then the promises are resolved in random order, which touches the awaiters the way a busy server does.
+constexpr size_t LIVE = 1000000;
+
+size_t heap_in_use() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+#else
+    return 0;   // not measured on this platform
+#endif
+}
+
+io::fsm_func<void> future_memory_benchmark() {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    std::vector<io::future> futures(LIVE);
+    std::vector<io::promise<void>> promises(LIVE);
+    std::vector<size_t> order(LIVE);
+    for (size_t i = 0; i < LIVE; i++)
+        order[i] = i;
+    std::shuffle(order.begin(), order.end(), std::mt19937_64(42));
+    io::timer::up timer;
+
+    while (1) {
+        size_t before = heap_in_use();
+        timer.start();
+        for (size_t i = 0; i < LIVE; i++)
+            promises[i] = fsm.make_future(futures[i]);
+        auto duration_make = std::chrono::duration_cast<std::chrono::nanoseconds>(timer.lap());
+        size_t after = heap_in_use();
+
+        for (size_t i : order)
+            promises[i].resolve();
+        auto duration_resolve = std::chrono::duration_cast<std::chrono::nanoseconds>(timer.lap());
+        size_t settled = 0;
+        for (size_t i : order)
+            settled += futures[i].isSet();
+        auto duration_check = std::chrono::duration_cast<std::chrono::nanoseconds>(timer.lap());
+        for (auto& fut : futures)
+            fut = io::future();
+
+        std::cout << LIVE << " live futures:\n";
+        if (after)
+            std::cout << "  heap per live future: " << double(after - before) / LIVE << " bytes\n";
+        std::cout << "  make_future: " << duration_make.count() / double(LIVE) << " ns\n"
+            << "  resolve, random order: " << duration_resolve.count() / double(LIVE) << " ns\n"
+            << "  isSet, random order: " << duration_check.count() / double(LIVE) << " ns (" << settled << " set)\n" << std::endl;
+        co_await fsm.setTimeout(std::chrono::milliseconds(100));
+    }
+}
+
+int main()
+{
+    io::manager mngr;
+    mngr.async_spawn(future_memory_benchmark());
+
+    while (1)
+    {
+        mngr.drive();
+    }
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include <ioManager/ioManager.h>
+#include <ioManager/timer.h>
+
+// Coroutine migration between managers.
+// First a coroutine moves to a pool thread and back, carrying settled futures along, and is refused while one is pending.
+// Then CONNECTIONS busy coroutines all start on the first thread of the pool. Each turn burns WORK of CPU, sleeps,
+//  then offers to move with rebalance: the saturated thread sheds them to the idle ones until the loads even out.
+constexpr size_t THREADS = 4;
+constexpr size_t CONNECTIONS = 64;
+constexpr auto WORK = std::chrono::microseconds(50);
+
+size_t thread_of(io::pool& workers, io::manager* mngr) {
+    for (size_t i = 0; i < workers.threadsInPool.size(); i++)
+        if (workers.threadsInPool[i].mngr == mngr)
+            return i;
+    return workers.threadsInPool.size();
+}
+
+io::fsm_func<void> connection(io::pool& workers, std::vector<std::atomic<size_t>>& on_thread) {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    on_thread[thread_of(workers, fsm.getManager())]++;
+    while (1) {
+        auto busy_until = std::chrono::steady_clock::now() + WORK;
+        while (std::chrono::steady_clock::now() < busy_until);
+
+        co_await fsm.setTimeout(std::chrono::milliseconds(1));
+        io::manager* before = fsm.getManager();
+        co_await workers.rebalance(before);
+        if (fsm.getManager() != before)
+        {
+            on_thread[thread_of(workers, before)]--;
+            on_thread[thread_of(workers, fsm.getManager())]++;
+        }
+    }
+}
+
+io::fsm_func<void> migrate_benchmark() {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    io::manager* home = fsm.getManager();
+    io::pool workers(THREADS);
+    io::manager* worker = workers.getManager();
+
+    io::future pending;
+    io::promise<void> prom = fsm.make_future(pending);
+    bool moved = co_await io::migrate_to(worker, pending);
+    std::cout << "pending future held, migration " << (moved ? "done" : "refused") << "\n";
+    prom.resolve();
+
+    io::future_with<int> answer;
+    fsm.make_future(answer, &answer.data).resolve(42);
+    io::future failed;
+    fsm.make_future(failed).reject(std::string("carried along"));
+    moved = co_await io::migrate_to(worker, pending, answer, failed);
+    std::cout << "settled futures held, migration " << (moved ? "done" : "refused")
+        << (io::this_manager() == worker ? ", on the pool thread" : ", still at home")
+        << ": resolved " << (pending.isSet() && !pending.getErr())
+        << ", data " << answer.data << ", error \"" << failed.getErr().message() << "\"\n";
+    co_await io::migrate_to(home, pending, answer, failed);
+    std::cout << "back " << (io::this_manager() == home ? "home" : "nowhere") << "\n\n";
+
+    io::timer::up timer;
+    timer.start();
+    for (size_t i = 0; i < 200; i++)
+        co_await io::migrate_to(i % 2 ? home : worker);
+    std::cout << "round trip home -> pool thread -> home: " << std::chrono::duration_cast<std::chrono::nanoseconds>(timer.lap()).count() / 100.0 << " ns\n\n";
+
+    std::vector<std::atomic<size_t>> on_thread(THREADS);
+    for (size_t i = 0; i < CONNECTIONS; i++)
+        workers.threadsInPool[0].mngr->async_spawn(connection(workers, on_thread));
+    while (1) {
+        co_await fsm.setTimeout(std::chrono::milliseconds(500));
+        auto loads = workers.loads();
+        std::cout << "thread: busy, coroutines\n";
+        for (size_t i = 0; i < THREADS; i++)
+            std::cout << "  " << i << ": " << int(loads[i] * 100) << "%, " << on_thread[i] << "\n";
+        std::cout << std::endl;
+    }
+}
+
+int main()
+{
+    io::manager mngr;
+    mngr.async_spawn(migrate_benchmark());
+
+    while (1)
+    {
+        mngr.drive();
+    }
+
+    return 0;
+}
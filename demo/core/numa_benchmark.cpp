@@ -0,0 +1,82 @@
+#include <ioManager/ioManager.h>
+#include <ioManager/timer.h>
+
+// Local versus remote memory with a NUMA aware io::pool: one thread per node, pinned to the CPUs of its node.
+// A buffer is allocated and first touched by the thread of one node, then read by the thread of every node.
+// Then round trips from this manager to a thread on every node, with the threads' managers made on their own nodes.
+// On a machine with one node there is nothing remote, only the local row is printed.
+constexpr size_t BUFFER_WORDS = size_t(64) << 20 >> 3;     // 64 MB, well past the caches
+constexpr size_t PASSES = 5;
+constexpr size_t ROUND_TRIPS = 20000;
+
+io::fsm_func<void> numa_benchmark() {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    const io::cpu_topology& topology = io::cpu_topology::get();
+    io::pool::options options;
+    options.affinity = io::pool::affinity::node;
+    options.threads = topology.nodes;
+    io::pool workers(options);
+
+    std::cout << topology.nodes << " NUMA node(s), " << topology.allowed.size() << " CPUs\n";
+    for (auto& t : workers.threadsInPool) {
+        std::cout << "  thread on node " << t.node << ", CPUs";
+        for (int cpu : t.cpus)
+            std::cout << " " << cpu;
+        std::cout << "\n";
+    }
+
+    while (1) {
+        for (size_t home = 0; home < topology.nodes; home++)
+        {
+            // allocated and first touched on the home node
+            auto buffer = workers.post(io::pool::on_node((int)home), fsm.getManager(), []() {
+                return std::make_unique<std::vector<uint64_t>>(BUFFER_WORDS, 1);
+                });
+            co_await buffer;
+            std::vector<uint64_t>* words = buffer.data.get();
+
+            for (size_t reader = 0; reader < topology.nodes; reader++)
+            {
+                auto seconds = workers.post(io::pool::on_node((int)reader), fsm.getManager(), [words]() {
+                    io::timer::up timer;
+                    timer.start();
+                    uint64_t sum = 0;
+                    for (size_t k = 0; k < PASSES; k++)
+                        for (uint64_t w : *words)
+                            sum += w;
+                    double elapsed = std::chrono::duration<double>(timer.lap()).count();
+                    return sum == BUFFER_WORDS * PASSES ? elapsed : -1.0;
+                    });
+                co_await seconds;
+                std::cout << "memory on node " << home << ", read on node " << reader
+                    << (home == reader ? " (local): " : " (remote): ")
+                    << BUFFER_WORDS * 8 * PASSES / seconds.data / 1e9 << " GB/s\n";
+            }
+        }
+
+        for (size_t node = 0; node < topology.nodes; node++)
+        {
+            io::timer::up timer;
+            timer.start();
+            for (size_t i = 0; i < ROUND_TRIPS; i++)
+                co_await workers.post(io::pool::on_node((int)node), fsm.getManager(), []() {});
+            std::cout << "post round trip to node " << node << ": "
+                << std::chrono::duration_cast<std::chrono::nanoseconds>(timer.lap()).count() / double(ROUND_TRIPS) << " ns\n";
+        }
+        std::cout << std::endl;
+        co_await fsm.setTimeout(std::chrono::seconds(1));
+    }
+}
+
+int main()
+{
+    io::manager mngr;
+    mngr.async_spawn(numa_benchmark());
+
+    while (1)
+    {
+        mngr.drive();
+    }
+
+    return 0;
+}
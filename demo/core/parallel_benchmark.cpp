@@ -0,0 +1,117 @@
+#include <ioManager/ioManager.h>
+#include <ioManager/timer.h>
+#include <cmath>
+
+// The data parallel algorithms of io::pool, on 1 to MAX_THREADS threads, against a plain loop on this thread:
+//   parallel_for scores 1M records, transform_reduce sums the scores, sort sorts 1M random keys.
+// This manager only awaits, it stays free for other coroutines while the pool works.
+constexpr size_t RECORDS = 1000000;
+constexpr size_t REPEAT = 5;
+
+struct record {
+    uint64_t key;
+    double score;
+};
+
+double score_of(uint64_t key) {
+    double x = double(key % 1000) / 1000.0;
+    for (int i = 0; i < 20; i++)
+        x = std::sin(x) * 0.5 + x * 0.5;
+    return x;
+}
+
+template <typename F>
+double milliseconds(F&& func) {
+    io::timer::up timer;
+    timer.start();
+    func();
+    return std::chrono::duration<double, std::milli>(timer.lap()).count() / REPEAT;
+}
+
+io::fsm_func<void> parallel_benchmark() {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    size_t max_threads = std::max<size_t>(4, std::thread::hardware_concurrency());
+    std::vector<record> records(RECORDS);
+    std::vector<uint64_t> keys(RECORDS), shuffled(RECORDS);
+    std::mt19937_64 rng(42);
+    for (size_t i = 0; i < RECORDS; i++)
+        records[i].key = shuffled[i] = rng();
+
+    // the plain loops, on this thread
+    double serial_score = milliseconds([&]() {
+        for (size_t k = 0; k < REPEAT; k++)
+            for (auto& r : records)
+                r.score = score_of(r.key);
+        });
+    double serial_sum = 0;
+    double serial_reduce = milliseconds([&]() {
+        for (size_t k = 0; k < REPEAT; k++)
+        {
+            serial_sum = 0;
+            for (auto& r : records)
+                serial_sum += r.score;
+        }
+        });
+    double serial_sort = milliseconds([&]() {
+        for (size_t k = 0; k < REPEAT; k++)
+        {
+            keys = shuffled;
+            std::sort(keys.begin(), keys.end());
+        }
+        });
+
+    while (1) {
+        std::cout << RECORDS << " records, plain loop on this thread: score " << serial_score << " ms, sum "
+            << serial_reduce << " ms, sort " << serial_sort << " ms\n";
+        for (size_t threads = 1; threads <= max_threads; threads++)
+        {
+            io::pool thread_pool(threads);
+            io::timer::up timer;
+
+            timer.start();
+            for (size_t k = 0; k < REPEAT; k++)
+                co_await thread_pool.parallel_for(fsm.getManager(), records.begin(), records.end(),
+                    [](record& r) { r.score = score_of(r.key); });
+            double score = std::chrono::duration<double, std::milli>(timer.lap()).count() / REPEAT;
+
+            double sum = 0;
+            for (size_t k = 0; k < REPEAT; k++)
+            {
+                auto total = thread_pool.transform_reduce(fsm.getManager(), records.begin(), records.end(), 0.0,
+                    std::plus<>(), [](const record& r) { return r.score; });
+                co_await total;
+                sum = total.data;
+            }
+            double reduce = std::chrono::duration<double, std::milli>(timer.lap()).count() / REPEAT;
+
+            double sort = 0;
+            for (size_t k = 0; k < REPEAT; k++)
+            {
+                keys = shuffled;
+                timer.lap();
+                co_await thread_pool.sort(fsm.getManager(), keys.begin(), keys.end());
+                sort += std::chrono::duration<double, std::milli>(timer.lap()).count() / REPEAT;
+            }
+
+            std::cout << "  " << threads << " threads: score " << score << " ms (x" << serial_score / score
+                << "), sum " << reduce << " ms (x" << serial_reduce / reduce
+                << "), sort " << sort << " ms (x" << serial_sort / sort << ")"
+                << (std::abs(sum - serial_sum) < 1e-6 * serial_sum && std::is_sorted(keys.begin(), keys.end()) ? "" : " WRONG RESULT")
+                << "\n";
+        }
+        std::cout << std::endl;
+    }
+}
+
+int main()
+{
+    io::manager mngr;
+    mngr.async_spawn(parallel_benchmark());
+
+    while (1)
+    {
+        mngr.drive();
+    }
+
+    return 0;
+}
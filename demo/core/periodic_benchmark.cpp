@@ -0,0 +1,99 @@
+#include <ioManager/ioManager.h>
+#include <ioManager/timer.h>
+#include <ctime>
+
+// 10000 coroutines ticking every 10 ms for a few seconds, three ways:
+//   make_clock again after every tick (the re-arm pattern),
+//   io::timer::down (compensated re-arm),
+//   io::periodic (re-armed in place by the manager).
+// Prints the CPU time the thread spent per tick. Nothing else runs, so the manager sleeps between ticks.
+// The re-arm patterns run again with the manager reading the clock once per turn (io::tick_mode).
+constexpr size_t TIMERS = 10000;
+constexpr auto PERIOD = std::chrono::milliseconds(10);
+constexpr auto ROUND_TIME = std::chrono::seconds(3);
+
+size_t ticks = 0;
+
+io::fsm_func<void> rearm_clock() {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    io::clock clk;
+    while (1) {
+        fsm.make_clock(clk, PERIOD);
+        co_await clk;
+        ticks++;
+    }
+}
+
+io::fsm_func<void> down_timer() {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    io::timer::down timer(SIZE_MAX);
+    timer.start(PERIOD);
+    timer.reset();
+    while (1) {
+        co_await timer.await_tm(fsm);
+        ticks++;
+    }
+}
+
+io::fsm_func<void> periodic_clock() {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    io::periodic tick;
+    fsm.make_periodic(tick, PERIOD);
+    while (1) {
+        co_await tick;
+        ticks++;
+    }
+}
+
+// the timers are destroyed with their handles when the round returns
+io::future_fsm_func_ round(const char* name, io::fsm_func<void>(*func)(), io::tick_mode mode = io::tick_mode::precise) {
+    io::fsm<io::future>& fsm = co_await io::get_fsm;
+    fsm.getManager()->set_tick_mode(mode);
+    std::vector<io::fsm_handle<void>> handles;
+    for (size_t i = 0; i < TIMERS; i++)
+        handles.push_back(fsm.spawn_now(func()));
+    co_await fsm.setTimeout(PERIOD * 10);    // warm up
+
+    size_t begin = ticks;
+    std::clock_t cpu_begin = std::clock();
+    co_await fsm.setTimeout(ROUND_TIME);
+    double cpu_ns = double(std::clock() - cpu_begin) / CLOCKS_PER_SEC * 1e9;
+    size_t count = ticks - begin;
+    double seconds = std::chrono::duration<double>(ROUND_TIME).count();
+
+    std::cout << name << ":\n"
+        << "  ticks per second: " << static_cast<size_t>(count / seconds)
+        << " (expected " << static_cast<size_t>(TIMERS * (std::chrono::seconds(1) / PERIOD)) << ")\n"
+        << "  CPU usage: " << cpu_ns / 1e7 / seconds << " %\n"
+        << "  CPU time per tick: " << cpu_ns / count << " ns\n";
+    fsm.getManager()->set_tick_mode(io::tick_mode::precise);
+    co_return;
+}
+
+io::fsm_func<void> periodic_benchmark() {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    std::cout << TIMERS << " timers, period " << PERIOD.count() << " ms\n";
+    while (1) {
+        co_await *fsm.spawn_now(round("make_clock every tick", rearm_clock));
+        co_await *fsm.spawn_now(round("io::timer::down", down_timer));
+        co_await *fsm.spawn_now(round("io::periodic", periodic_clock));
+        co_await *fsm.spawn_now(round("make_clock every tick, cached tick", rearm_clock, io::tick_mode::cached));
+        co_await *fsm.spawn_now(round("io::timer::down, cached tick", down_timer, io::tick_mode::cached));
+        co_await *fsm.spawn_now(round("make_clock every tick, coarse tick", rearm_clock, io::tick_mode::coarse));
+        co_await *fsm.spawn_now(round("io::timer::down, coarse tick", down_timer, io::tick_mode::coarse));
+        std::cout << std::endl;
+    }
+}
+
+int main()
+{
+    io::manager mngr;
+    mngr.async_spawn(periodic_benchmark());
+
+    while (1)
+    {
+        mngr.drive();
+    }
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <ioManager/ioManager.h>
+#include <ioManager/pipeline.h>
+#include <ioManager/timer.h>
+
+// Cost of one item through pipelines of 1 to 16 segments.
+// Every stage settles its futures at once, so the time is the pipeline's own dispatch.
+constexpr size_t ITEMS = 1000000;
+
+// outputs 0, 1, 2, ...
+struct source {
+    using prot_output_type = int;
+    int counter = 0;
+    inline void operator>>(io::future_with<int>& fut) {
+        fut.data = counter++;
+        io::make_ready_future(fut);
+    }
+};
+
+// forwards its input to its output, one item at a time.
+struct relay {
+    using prot_output_type = int;
+    io::protocol_lock<int> lock;
+    inline io::future operator<<(int& in) {
+        io::future fut;
+        lock.temp = in;
+        lock.send_or_wait(fut, io::this_manager());
+        return fut;
+    }
+    inline void operator>>(io::future_with<int>& fut) {
+        lock.send_prom = io::make_future(fut, &fut.data);
+        lock.template try_send<io::out_side>();
+    }
+};
+
+struct sink {
+    size_t received = 0;
+    inline void operator<<(int&) { received++; }
+};
+
+template <size_t N, typename P>
+inline auto chain(P&& p, relay* relays, sink& s) {
+    if constexpr (N == 0)
+        return std::forward<P>(p) >> s;
+    else
+        return chain<N - 1>(std::forward<P>(p) >> relays[N - 1], relays, s);
+}
+
+template <size_t Length>
+io::future_fsm_func_ measure() {
+    source src;
+    std::array<relay, Length - 1> relays;
+    sink s;
+    auto started = chain<Length - 1>(io::pipeline<>() >> src, relays.data(), s).start();
+
+    io::timer::up timer;
+    timer.start();
+    while (s.received < ITEMS) {
+        started <= co_await +started;
+    }
+    auto duration = timer.lap();
+    std::cout << Length << " segments: " << std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / ITEMS
+        << " ns per item, " << std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / ITEMS / Length
+        << " ns per item and segment" << std::endl;
+    co_return;
+}
+
+io::fsm_func<void> pipeline_benchmark() {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    while (1) {
+        co_await *fsm.spawn_now(measure<1>());
+        co_await *fsm.spawn_now(measure<2>());
+        co_await *fsm.spawn_now(measure<4>());
+        co_await *fsm.spawn_now(measure<8>());
+        co_await *fsm.spawn_now(measure<16>());
+        std::cout << std::endl;
+    }
+}
+
+int main()
+{
+    io::manager mngr;
+    mngr.async_spawn(pipeline_benchmark());
+
+    while (1)
+    {
+        mngr.drive();
+    }
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+#define IO_USE_PIPELINE_STATS 1
+#include <ioManager/ioManager.h>
+#include <ioManager/pipeline.h>
+#include <ioManager/rpc.h>
+
+// Per segment counters of a pipeline with a slow stage:
+// counter >> rpc_adaptor (coroutines sleeping 1~3 ms, 8 in flight) >> to_string, drops every 10th >> sink
+// The segments before and after the slow stage show where the time goes.
+
+// outputs 0, 1, 2, ... through a future
+struct CounterProtocol {
+    using prot_output_type = int;
+    int counter = 0;
+    io::manager* mngr;
+    CounterProtocol(io::manager* mngr) :mngr(mngr) {}
+
+    void operator>>(io::future_with<int>& fut) {
+        mngr->make_future(fut, &fut.data).resolve(counter++);
+    }
+};
+
+struct SinkProtocol {
+    size_t received = 0;
+    void operator<<(std::string& s) { received++; }
+};
+
+void print_stats(const auto& stats) {
+    const char* names[] = { "counter >> slow", "slow >> sink" };
+    for (size_t i = 0; i < stats.size(); i++) {
+        auto& st = stats[i];
+        std::cout << "  segment " << i << " (" << names[i] << "): in " << st.items_in << ", out " << st.items_out
+            << ", errors " << st.errors << std::endl;
+        std::cout << "    waiting on front " << std::chrono::duration_cast<std::chrono::milliseconds>(st.front_wait).count()
+            << " ms, on rear " << std::chrono::duration_cast<std::chrono::milliseconds>(st.rear_wait).count() << " ms" << std::endl;
+        std::cout << "    latency p50 " << st.latency.percentile(50).count() << " ns, p99 " << st.latency.percentile(99).count()
+            << " ns, max " << st.latency.max().count() << " ns, mean " << st.latency.mean().count() << " ns" << std::endl;
+    }
+}
+
+io::fsm_func<void> pipeline_stats_test() {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    CounterProtocol counter(fsm.getManager());
+    SinkProtocol sink;
+    io::rpc_adaptor<int, int> slow(fsm, [](int n) -> io::future_fsm_func<int> {
+        io::fsm<io::future_with<int>>& fsm = co_await io::get_fsm;
+        co_await fsm.setTimeout(std::chrono::milliseconds(1 + n % 3));
+        fsm->data = n;
+        co_return;
+        }, 8);
+
+    auto started = (io::pipeline<>() >> counter >> slow >> [](int& n) -> std::optional<std::string> {
+        if (n % 10 == 9)
+            return std::nullopt;
+        return std::to_string(n);
+    } >> sink).spawn(fsm);
+
+    while (1) {
+        co_await fsm.setTimeout(std::chrono::seconds(1));
+        std::cout << "received " << sink.received << std::endl;
+        print_stats(started.stats());
+        std::cout << std::endl;
+    }
+}
+
+int main()
+{
+    io::manager mngr;
+    mngr.async_spawn(pipeline_stats_test());
+
+    while (1)
+    {
+        mngr.drive();
+    }
+
+    return 0;
+}
@@ -1,5 +1,7 @@
 #include <ioManager/ioManager.h>
 #include <ioManager/pipeline.h>
+#include <ioManager/timer.h>
+#include <ioManager/protocol/async_chan.h>
 
 io::fsm_func<void> pipeline_test() {
 
@@ -273,6 +275,151 @@ io::fsm_func<void> pipeline_test() {
         }
     }
     
+    // Test 7: in-flight depth, a jittery producer against a jittery consumer
+    std::cout << "\n--- Test 7: io::in_flight throughput against depth 1 ---\n" << std::endl;
+    {
+        // Both sides take 0~400us per item, settled by a timer.
+        struct DelayedOutputProtocol {
+            using prot_output_type = int;
+            std::mt19937 rng{ 1 };
+            int counter = 0;
+
+            void operator>>(io::future_with<int>& fut) {
+                io::promise<int> prom = io::make_future(fut, &fut.data);
+                io::spawn_later([](io::promise<int> prom, int value, std::chrono::microseconds delay) -> io::fsm_func<void> {
+                    io::fsm<void>& fsm = co_await io::get_fsm;
+                    co_await fsm.setTimeout(delay);
+                    prom.resolve(value);
+                    }(std::move(prom), counter++, std::chrono::microseconds(rng() % 400))).detach();
+            }
+        };
+        struct DelayedInputProtocol {
+            std::mt19937 rng{ 2 };
+            int expected = 0;
+            bool in_order = true;
+
+            io::future operator<<(int& input) {
+                in_order &= input == expected++;
+                io::future fut;
+                io::promise<void> prom = io::make_future(fut);
+                io::spawn_later([](io::promise<void> prom, std::chrono::microseconds delay) -> io::fsm_func<void> {
+                    io::fsm<void>& fsm = co_await io::get_fsm;
+                    co_await fsm.setTimeout(delay);
+                    prom.resolve();
+                    }(std::move(prom), std::chrono::microseconds(rng() % 400))).detach();
+                return fut;
+            }
+        };
+        constexpr int ITEMS = 2000;
+        auto measure = [](const char* name, auto& started_pipeline, DelayedInputProtocol& input_prot) -> io::future_fsm_func_ {
+            io::timer::up timer;
+            timer.start();
+            while (input_prot.expected < ITEMS) {
+                started_pipeline <= co_await +started_pipeline;
+            }
+            double seconds = std::chrono::duration<double>(timer.lap()).count();
+            std::cout << name << ": " << static_cast<size_t>(ITEMS / seconds) << " items/s"
+                << (input_prot.in_order ? ", in order" : ", OUT OF ORDER") << std::endl;
+            co_return;
+            };
+        {
+            DelayedOutputProtocol output_prot;
+            DelayedInputProtocol input_prot;
+            auto started_pipeline = (io::pipeline<>() >> output_prot >> input_prot).start();
+            co_await *fsm.spawn_now(measure("depth 1", started_pipeline, input_prot));
+        }
+        {
+            DelayedOutputProtocol output_prot;
+            DelayedInputProtocol input_prot;
+            auto started_pipeline = (io::pipeline<>() >> output_prot >> io::in_flight<2> >> input_prot).start();
+            co_await *fsm.spawn_now(measure("depth 2", started_pipeline, input_prot));
+        }
+        {
+            DelayedOutputProtocol output_prot;
+            DelayedInputProtocol input_prot;
+            auto started_pipeline = (io::pipeline<>() >> output_prot >> io::in_flight<8> >> input_prot).start();
+            co_await *fsm.spawn_now(measure("depth 8", started_pipeline, input_prot));
+        }
+        {
+            // adaptor after the depth marker, three segments deep
+            DelayedOutputProtocol output_prot;
+            FutureBidirectionalProtocol middle_prot(fsm.getManager());
+            DelayedInputProtocol input_prot;
+            auto started_pipeline = (io::pipeline<>() >> output_prot >> io::in_flight<8>
+                >> [](int& value) -> std::optional<int> { return value; } >> middle_prot
+                >> [](int& value) -> std::optional<int> { return value - 100; } >> input_prot).start();
+            for (int i = 0; i < 10; i++) {
+                started_pipeline <= co_await +started_pipeline;
+            }
+        }
+    }
+
+    // Test 8: batch protocols, prot::chan into a sink with and without a batch input
+    std::cout << "\n--- Test 8: batch segment against per item segment ---\n" << std::endl;
+    {
+        struct CountingSink {
+            size_t count = 0;
+            void operator<<(int& input) { count++; }
+        };
+        struct BatchCountingSink : CountingSink {
+            using CountingSink::operator<<;
+            void operator<<(std::span<int> batch) { count += batch.size(); }
+        };
+        constexpr size_t ITEMS = 1000000;
+        constexpr size_t CHUNK = 256;
+        auto producer = [](io::chan<int> ch) -> io::fsm_func<void> {
+            std::vector<int> chunk(CHUNK);
+            for (size_t i = 0; i < ITEMS / CHUNK; i++) {
+                std::iota(chunk.begin(), chunk.end(), 0);
+                co_await (ch << std::span<int>(chunk));
+            }
+            };
+        auto measure = [](const char* name, auto& started_pipeline, CountingSink& sink) -> io::future_fsm_func_ {
+            io::timer::up timer;
+            timer.start();
+            while (sink.count < ITEMS / CHUNK * CHUNK) {
+                started_pipeline <= co_await +started_pipeline;
+            }
+            double seconds = std::chrono::duration<double>(timer.lap()).count();
+            std::cout << name << ": " << static_cast<size_t>(sink.count / seconds) << " items/s" << std::endl;
+            co_return;
+            };
+        {
+            io::chan<int> ch(fsm, 1024);
+            CountingSink sink;
+            auto started_pipeline = (io::pipeline<>() >> io::prot::chan(ch) >> sink).start();
+            auto h = fsm.spawn_now(producer(ch));
+            co_await *fsm.spawn_now(measure("per item", started_pipeline, sink));
+        }
+        {
+            io::chan<int> ch(fsm, 1024);
+            BatchCountingSink sink;
+            auto started_pipeline = (io::pipeline<>() >> io::prot::chan(ch) >> sink).start();
+            auto h = fsm.spawn_now(producer(ch));
+            co_await *fsm.spawn_now(measure("batch", started_pipeline, sink));
+        }
+        {
+            // a batch read takes the elements of blocked senders too, and waits for one only on an empty channel
+            io::chan<int> ch(fsm, 4);
+            io::prot::chan<int> out(ch);
+            std::vector<int> items(10);
+            std::iota(items.begin(), items.end(), 0);
+            io::future sent = ch << std::span<int>(items);
+            io::future_with<std::vector<int>> batch;
+            out >> batch;
+            co_await batch;
+            std::cout << "batch read with a blocked sender: " << batch.data.size() << " items (expected 10)" << std::endl;
+            co_await sent;
+            out >> batch;
+            bool waited = !batch.isSet();
+            int one = 42;
+            co_await (ch << std::span<int>(&one, 1));
+            co_await batch;
+            std::cout << "batch read on an empty channel: " << (waited ? "waited" : "did not wait") << ", "
+                << batch.data.size() << " item (expected 1)" << std::endl;
+        }
+    }
+
     std::cout << "\n=== Pipeline Testing Complete ===\n" << std::endl;
     
     co_return;
@@ -0,0 +1,58 @@
+#include <ioManager/ioManager.h>
+
+// Ready futures share one resolved awaiter per manager. Re-arming a future that was ready must give it an awaiter of its own,
+// and leave the shared one resolved for every other ready future.
+int failures = 0;
+
+void check(bool ok, const char* what) {
+    std::cout << (ok ? "  ok: " : "  FAILED: ") << what << "\n";
+    failures += !ok;
+}
+
+io::fsm_func<void> ready_future_test() {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+
+    io::future fut;
+    fsm.make_ready_future(fut);
+    co_await fut;
+    io::promise<void> prom = fsm.make_future(fut);
+    check(!fut.isSet(), "a re-armed ready future is pending");
+    prom.resolve();
+    co_await fut;
+    check(fut.isSet() && !fut.getErr(), "and settles through its own promise");
+
+    io::async_future async_fut;
+    fsm.make_ready_future(async_fut);
+    co_await async_fut;
+    io::async_promise async_prom = fsm.make_future(async_fut);
+    check(!async_fut.isSet(), "a re-armed ready async_future is pending");
+    async_prom.reject(std::errc::operation_canceled);
+    co_await async_fut;
+    check(async_fut.getErr() == std::errc::operation_canceled, "and settles through its own async_promise");
+
+    for (int i = 0; i < 3; i++)
+    {
+        io::future other;
+        fsm.make_ready_future(other);
+    }
+    io::future later;
+    fsm.make_ready_future(later);
+    check(later.isSet() && !later.getErr(), "ready futures made after that are still resolved");
+    co_await later;
+
+    std::cout << (failures ? "FAILED" : "PASSED") << std::endl;
+    std::exit(failures ? 1 : 0);
+}
+
+int main()
+{
+    io::manager mngr;
+    mngr.async_spawn(ready_future_test());
+
+    while (1)
+    {
+        mngr.drive();
+    }
+
+    return 0;
+}
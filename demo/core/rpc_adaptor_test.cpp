@@ -0,0 +1,146 @@
+#include <ioManager/ioManager.h>
+#include <ioManager/pipeline.h>
+#include <ioManager/rpc.h>
+#include <ioManager/timer.h>
+
+// outputs 0, 1, 2, ... through a future
+struct CounterProtocol {
+    using prot_output_type = int;
+    int counter = 0;
+    io::manager* mngr;
+    CounterProtocol(io::manager* mngr) :mngr(mngr) {}
+
+    void operator>>(io::future_with<int>& fut) {
+        mngr->make_future(fut, &fut.data).resolve(counter++);
+    }
+};
+
+// checks that responses arrive in the order of requests
+struct OrderCheckProtocol {
+    size_t received = 0;
+    size_t disorder = 0;
+    void operator<<(std::string& rsp) {
+        if (rsp != std::to_string(received))
+            disorder++;
+        received++;
+    }
+};
+
+template <typename Adaptor>
+io::future_fsm_func_ run(Adaptor& adaptor, const char* name, size_t total) {
+    io::fsm<io::future>& fsm = co_await io::get_fsm;
+    CounterProtocol counter(fsm.getManager());
+    OrderCheckProtocol checker;
+    size_t rejected = 0;
+
+    auto started = (io::pipeline<>() >> counter >> adaptor >> checker).start(
+        [&](int which, bool output_or_input, std::error_code ec) {
+            rejected++;
+            checker.received++;
+        });
+
+    io::timer::up timer;
+    timer.start();
+    while (checker.received < total) {
+        started <= co_await +started;
+    }
+    auto duration = timer.lap();
+
+    std::cout << name << ":" << std::endl;
+    std::cout << "  Responses: " << checker.received << ", rejected: " << rejected
+        << ", out of order: " << checker.disorder << std::endl;
+    std::cout << "  Total time: " << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << " ms" << std::endl;
+    co_return;
+}
+
+io::fsm_func<void> rpc_adaptor_test() {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    constexpr size_t total = 1000;
+
+    // Coroutine handlers dispatched by io::async_rpc, each one sleeps 1~7 ms.
+    // Serially this takes about 4 seconds, with 64 in flight it takes about total / 64 * 7 ms.
+    io::async_rpc<int, int, std::string> rpc(
+        std::pair<int, io::async_rpc<int, int, std::string>::handler_type>{ 0, [](int n) -> io::future_fsm_func<std::string> {
+            io::fsm<io::future_with<std::string>>& fsm = co_await io::get_fsm;
+            co_await fsm.setTimeout(std::chrono::milliseconds(7 - n % 7));
+            fsm->data = std::to_string(n);
+            co_return;
+        } },
+        std::pair<int, io::async_rpc<int, int, std::string>::handler_type>{ 1, [](int n) -> io::future_fsm_func<std::string> {
+            io::fsm<io::future_with<std::string>>& fsm = co_await io::get_fsm;
+            if (n % 100 == 1) {
+                fsm->getPromise().reject(std::errc::invalid_argument);
+                co_return;
+            }
+            co_await fsm.setTimeout(std::chrono::milliseconds(1 + n % 7));
+            fsm->data = std::to_string(n);
+            co_return;
+        } }
+    );
+    {
+        io::rpc_adaptor<int, std::string> adaptor(fsm, [&rpc](int n) { return rpc(n % 2, n); });
+        io::future_fsm_handle_ h = fsm.spawn_now(run(adaptor, "Coroutine handlers, 64 in flight", total));
+        co_await *h;
+    }
+    {
+        io::rpc_adaptor<int, std::string> adaptor(fsm, [&rpc](int n) { return rpc(n % 2, n); }, 1);
+        io::future_fsm_handle_ h = fsm.spawn_now(run(adaptor, "Coroutine handlers, 1 in flight", total / 10));
+        co_await *h;
+    }
+
+    // Handlers filling a future_with, resolved by a timer of another coroutine.
+    {
+        io::rpc_adaptor<int, std::string> adaptor(fsm, [&fsm](int n, io::future_with<std::string>& fut) {
+            fsm.spawn_now([](int n, io::promise<std::string> prom) -> io::fsm_func<void> {
+                io::fsm<void>& fsm = co_await io::get_fsm;
+                co_await fsm.setTimeout(std::chrono::milliseconds(n % 5));
+                prom.resolve(std::to_string(n));
+            }(n, fsm.make_future(fut, &fut.data))).detach();
+        });
+        io::future_fsm_handle_ h = fsm.spawn_now(run(adaptor, "future_with handlers", total));
+        co_await *h;
+    }
+
+    // Synchronous handlers.
+    {
+        io::rpc_adaptor<int, std::string> adaptor(fsm, [](int n) { return std::to_string(n); });
+        io::future_fsm_handle_ h = fsm.spawn_now(run(adaptor, "Synchronous handlers", total * 100));
+        co_await *h;
+    }
+
+    // CPU heavy handlers, inline on the manager against io::parallel_adaptor on a pool.
+    {
+        auto heavy = [](int n) {
+            uint64_t h = n;
+            for (int i = 0; i < 200000; i++)
+                h = h * 6364136223846793005ull + 1442695040888963407ull;
+            return std::to_string(n + (h == 0));    // never 0, keeps the loop
+        };
+        {
+            io::rpc_adaptor<int, std::string> adaptor(fsm, heavy);
+            io::future_fsm_handle_ h = fsm.spawn_now(run(adaptor, "CPU heavy handlers, inline", total));
+            co_await *h;
+        }
+        io::pool workers(std::max(2u, std::thread::hardware_concurrency()));
+        {
+            io::parallel_adaptor<int, std::string> adaptor(fsm, workers, heavy);
+            std::string name = "CPU heavy handlers, io::parallel_adaptor on " + std::to_string(workers.threadsInPool.size()) + " threads";
+            io::future_fsm_handle_ h = fsm.spawn_now(run(adaptor, name.c_str(), total));
+            co_await *h;
+        }
+    }
+    co_return;
+}
+
+int main()
+{
+    io::manager mngr;
+    mngr.async_spawn(rpc_adaptor_test());
+
+    while (1)
+    {
+        mngr.drive();
+    }
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <ioManager/ioManager.h>
+#include <ioManager/rpc.h>
+#include <ioManager/timer.h>
+
+// 1k routes: io::rpc (unordered_map, exact key) vs io::rpc_router (radix tree, static and parameter routes)
+constexpr size_t NUM_ROUTES = 1000;
+constexpr size_t NUM_LOOKUPS = 3000000;
+
+io::fsm_func<void> rpc_router_benchmark()
+{
+    io::fsm<void>& fsm = co_await io::get_fsm;
+
+    std::vector<std::string> static_urls;
+    std::vector<std::string> param_urls;
+    for (size_t i = 0; i < NUM_ROUTES; i++) {
+        static_urls.push_back("/api/v1/service" + std::to_string(i % 50) + "/method" + std::to_string(i));
+        param_urls.push_back("/api/v1/service" + std::to_string(i % 50) + "/method" + std::to_string(i) + "/" + std::to_string(i * 7));
+    }
+    std::vector<std::string> param_patterns;
+    for (size_t i = 0; i < NUM_ROUTES; i++) {
+        param_patterns.push_back("/api/v1/service" + std::to_string(i % 50) + "/method" + std::to_string(i) + "/:id");
+    }
+
+    // the dispatch table of io::rpc<std::string_view, ...>
+    std::unordered_map<std::string_view, std::function<size_t(size_t)>> rpc_map;
+    io::rpc_router<size_t, size_t> router_static;
+    io::rpc_router<size_t, size_t> router_param;
+    for (size_t i = 0; i < NUM_ROUTES; i++) {
+        rpc_map[static_urls[i]] = [i](size_t x) { return x + i; };
+        router_static.add("GET", static_urls[i], [i](size_t x, io::route_params&) { return x + i; });
+        router_param.add("GET", param_patterns[i], [i](size_t x, io::route_params& p) { return x + i + p["id"].size(); });
+    }
+
+    std::mt19937 gen(42);
+    std::vector<uint32_t> order(65536);
+    for (auto& o : order)
+        o = gen() % NUM_ROUTES;
+
+    io::timer::up timer;
+    size_t sink = 0;
+
+    timer.start();
+    for (size_t i = 0; i < NUM_LOOKUPS; i++)
+        sink += rpc_map.find(std::string_view(static_urls[order[i % order.size()]]))->second(i);
+    auto map_time = std::chrono::duration_cast<std::chrono::microseconds>(timer.lap());
+
+    for (size_t i = 0; i < NUM_LOOKUPS; i++)
+        sink += router_static("GET", static_urls[order[i % order.size()]], i);
+    auto static_time = std::chrono::duration_cast<std::chrono::microseconds>(timer.lap());
+
+    for (size_t i = 0; i < NUM_LOOKUPS; i++)
+        sink += router_param("GET", param_urls[order[i % order.size()]], i);
+    auto param_time = std::chrono::duration_cast<std::chrono::microseconds>(timer.lap());
+
+    auto report = [](const char* name, std::chrono::microseconds t) {
+        std::cout << name << ":\n"
+            << "  Total time: " << t.count() / 1000.0 << " ms\n"
+            << "  Lookups per second: " << static_cast<size_t>(NUM_LOOKUPS * 1000000.0 / t.count()) << "\n"
+            << "  Average lookup time: " << t.count() * 1000.0 / NUM_LOOKUPS << " ns\n";
+    };
+    std::cout << "RPC Routing Benchmark (" << NUM_ROUTES << " routes, " << NUM_LOOKUPS << " lookups):\n";
+    report("io::rpc (unordered_map, exact url)", map_time);
+    report("io::rpc_router (static routes)", static_time);
+    report("io::rpc_router (\":id\" parameter routes)", param_time);
+    std::cout << "(checksum " << sink << ")\n\n\n";
+
+    fsm.getManager()->spawn_later(rpc_router_benchmark()).detach();
+}
+
+int main()
+{
+    io::manager mngr;
+    mngr.async_spawn(rpc_router_benchmark());
+
+    while (1)
+    {
+        mngr.drive();
+    }
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <ioManager/ioManager.h>
+#include <ioManager/protocol/async_semaphore.h>
+#include <ioManager/timer.h>
+
+// State per key, updated by a producer on every pool thread, each one taking OPS operations on random keys:
+//   shared: one table of every key, an update holds an async::semaphore of one token.
+//   sharded: a key lives in the table of the thread owning it, by_key posts the update there. No lock: a table has one thread.
+// Then the pool grows by one thread, and the keys that moved are counted, against the hash modulo the thread count.
+constexpr size_t THREADS = 4;
+constexpr size_t KEYS = 4096;
+constexpr size_t OPS = 200000;      // per producer
+constexpr size_t WINDOW = 64;       // posts in flight per producer
+
+struct account {
+    uint64_t balance = 0;
+    uint64_t updates = 0;
+};
+
+io::fsm_func<void> shared_producer(io::async::semaphore lock, std::vector<account>& table, uint64_t seed, io::async::promise done) {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    lock.setManager(fsm.getManager());
+    std::mt19937_64 rng(seed);
+    for (size_t i = 0; i < OPS; i++)
+    {
+        uint64_t key = rng() % KEYS;
+        co_await lock.acquire();
+        table[key].balance += key;
+        table[key].updates++;
+        lock.release();
+    }
+    done.resolve();
+}
+
+io::fsm_func<void> sharded_producer(io::pool& workers, std::vector<std::unordered_map<uint64_t, account>>& tables, uint64_t seed, io::async::promise done) {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    std::mt19937_64 rng(seed);
+    std::vector<io::async_future> in_flight(WINDOW);
+    for (size_t i = 0; i < OPS; i++)
+    {
+        uint64_t key = rng() % KEYS;
+        if (i >= WINDOW)
+            co_await in_flight[i % WINDOW];
+        in_flight[i % WINDOW] = workers.post(io::pool::by_key(key), fsm.getManager(), [&tables, key]() {
+            // on the thread owning the key
+            account& a = tables[io::pool::shard_of(io::pool::hash_key(key), THREADS)][key];
+            a.balance += key;
+            a.updates++;
+            });
+    }
+    for (auto& fut : in_flight)
+        co_await fut;
+    done.resolve();
+}
+
+io::fsm_func<void> shard_benchmark() {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    io::pool workers(THREADS);
+
+    while (1) {
+        std::vector<account> table(KEYS);
+        io::async::semaphore lock(fsm.getManager(), 1);
+        std::vector<io::async::future> done(THREADS), sharded_done(THREADS);
+        io::timer::up timer;
+        timer.start();
+        for (size_t t = 0; t < THREADS; t++)
+            workers.threadsInPool[t].mngr->async_spawn(shared_producer(lock, table, t, fsm.make_future(done[t])));
+        for (auto& fut : done)
+            co_await fut;
+        double shared = std::chrono::duration<double>(timer.lap()).count();
+        uint64_t shared_updates = 0;
+        for (auto& a : table)
+            shared_updates += a.updates;
+
+        std::vector<std::unordered_map<uint64_t, account>> tables(THREADS);
+        timer.lap();
+        for (size_t t = 0; t < THREADS; t++)
+            workers.threadsInPool[t].mngr->async_spawn(sharded_producer(workers, tables, t, fsm.make_future(sharded_done[t])));
+        for (auto& fut : sharded_done)
+            co_await fut;
+        double sharded = std::chrono::duration<double>(timer.lap()).count();
+        uint64_t sharded_updates = 0;
+        for (auto& shard : tables)
+            for (auto& [key, a] : shard)
+                sharded_updates += a.updates;
+
+        std::cout << THREADS << " threads, " << THREADS * OPS << " updates of " << KEYS << " keys:\n"
+            << "  shared table, async::semaphore: " << THREADS * OPS / shared / 1e6 << " M updates/s"
+            << (shared_updates == THREADS * OPS ? "" : " WRONG RESULT") << "\n"
+            << "  sharded by key, no lock: " << THREADS * OPS / sharded / 1e6 << " M updates/s"
+            << (sharded_updates == THREADS * OPS ? "" : " WRONG RESULT") << "\n";
+
+        // re-sharding: one more thread
+        size_t moved = 0, moved_modulo = 0;
+        bool routed = true;
+        workers.resize(THREADS + 1);
+        for (uint64_t key = 0; key < KEYS; key++)
+        {
+            uint64_t hash = io::pool::hash_key(key);
+            moved += io::pool::shard_of(hash, THREADS) != io::pool::shard_of(hash, THREADS + 1);
+            moved_modulo += hash % THREADS != hash % (THREADS + 1);
+            routed &= workers.getManager(io::pool::by_key(key)) == workers.threadsInPool[io::pool::shard_of(hash, THREADS + 1)].mngr;
+        }
+        workers.resize(THREADS);
+        std::cout << "  growing to " << THREADS + 1 << " threads moves " << 100.0 * moved / KEYS << "% of the keys (hash modulo size: "
+            << 100.0 * moved_modulo / KEYS << "%)" << (routed ? "" : " WRONG ROUTE") << "\n" << std::endl;
+        co_await fsm.setTimeout(std::chrono::seconds(1));
+    }
+}
+
+int main()
+{
+    io::manager mngr;
+    mngr.async_spawn(shard_benchmark());
+
+    while (1)
+    {
+        mngr.drive();
+    }
+
+    return 0;
+}
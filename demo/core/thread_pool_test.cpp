@@ -1,6 +1,17 @@
 #include <ioManager/ioManager.h>
 #include <ioManager/timer.h>
 
+io::future_fsm_func_ sum_of_squares(io::pool& thread_pool, size_t begin, size_t count, size_t& sum)
+{
+    io::fsm<io::future>& fsm = co_await io::get_fsm;
+    for (size_t n = begin; n < begin + count; n++) {
+        auto future = thread_pool.post(fsm.getManager(), [](size_t n) { return n * n; }, n);
+        co_await future;
+        sum += future.data;
+    }
+    co_return;
+}
+
 io::fsm_func<void> thread_pool_test()
 {
     io::fsm<void>& fsm = co_await io::get_fsm;
@@ -62,10 +73,66 @@ io::fsm_func<void> thread_pool_test()
                   << " ms" << std::endl;
                   
         std::cout << "Tasks ran concurrently (total time < sum of individual task times)" << std::endl;
+    }
+
+    std::cout << "\n--- Test 3: Many small tasks ---\n" << std::endl;
+    {
+        // fine grained offload: the task is a few instructions, the time is the cost of post itself.
+        constexpr size_t NUM_TASKS = 200000;
+        constexpr size_t IN_FLIGHT = 1000;
+        std::vector<io::async_future> futures(IN_FLIGHT);
+        std::vector<size_t> results(NUM_TASKS);
+
+        // to the pool, and to this manager itself: the second one has no thread switches, only the post machinery.
+        for (io::manager* executor : { (io::manager*)nullptr, fsm.getManager() }) {
+            io::timer::up timer;
+            timer.start();
+            for (size_t i = 0; i < NUM_TASKS; i += IN_FLIGHT) {
+                for (size_t j = 0; j < IN_FLIGHT; j++) {
+                    auto task = [](size_t* result, size_t n) { *result = n * n; };
+                    if (executor)
+                        futures[j] = fsm.getManager()->post(executor, task, &results[i + j], i + j);
+                    else
+                        futures[j] = thread_pool.post(fsm.getManager(), task, &results[i + j], i + j);
+                }
+                for (auto& future : futures) {
+                    co_await future;
+                }
+            }
+            auto duration = timer.lap();
+            std::cout << NUM_TASKS << " tasks, " << IN_FLIGHT << " in flight, " << (executor ? "to this manager: " : "to the pool: ")
+                      << std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / double(NUM_TASKS)
+                      << " ns per task" << std::endl;
+        }
+    }
 
-        fsm.getManager()->spawn_later(thread_pool_test()).detach();
-        co_return;
+    std::cout << "\n--- Test 4: Tasks with a result ---\n" << std::endl;
+    {
+        // a function with a result: post returns async_future_with, the result is in its data once awaited.
+        // The futures are not movable, so every coroutine here keeps one call in flight.
+        constexpr size_t NUM_TASKS = 200000;
+        constexpr size_t IN_FLIGHT = 1000;
+        std::vector<io::fsm_handle<io::future>> callers;
+        size_t sum = 0;
+
+        io::timer::up timer;
+        timer.start();
+        for (size_t i = 0; i < IN_FLIGHT; i++)
+            callers.push_back(fsm.spawn_now(sum_of_squares(thread_pool, i * (NUM_TASKS / IN_FLIGHT), NUM_TASKS / IN_FLIGHT, sum)));
+        for (auto& caller : callers)
+            co_await *caller;
+        auto duration = timer.lap();
+        std::cout << NUM_TASKS << " tasks, " << IN_FLIGHT << " in flight, to the pool: "
+                  << std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / double(NUM_TASKS)
+                  << " ns per task, sum of squares " << sum << std::endl;
+
+        auto greeting = thread_pool.post(fsm.getManager(), [](std::string name) { return "hello, " + name; }, std::string("pool"));
+        co_await greeting;
+        std::cout << greeting.data << std::endl;
     }
+
+    fsm.getManager()->spawn_later(thread_pool_test()).detach();
+    co_return;
 }
 
 int main()
@@ -33,10 +33,34 @@ io::fsm_func<void> chan(size_t *count, size_t* throughput)
     co_return;
 }
 
+// sends and receives that never block: the channel always has the room or the data, every co_await returns at once.
+io::future_fsm_func_ nonblocking_benchmark()
+{
+    constexpr size_t CAPACITY = 1000;
+    constexpr size_t ROUNDS = 10000;
+    io::fsm<io::future>& fsm = co_await io::get_fsm;
+    io::chan<char> chan(fsm, CAPACITY);
+    char c = 'x';
+    std::span<char> one(&c, 1);
+
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t k = 0; k < ROUNDS; k++)
+    {
+        for (size_t i = 0; i < CAPACITY; i++)
+            co_await (chan << one);
+        for (size_t i = 0; i < CAPACITY; i++)
+            co_await chan.get_and_copy(one);
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin);
+    std::cout << "Non-blocking send/receive: " << duration.count() / double(ROUNDS * CAPACITY * 2) << " ns/op" << std::endl;
+    co_return;
+}
+
 io::fsm_func<void> chan_benchmark()
 {
     constexpr size_t TEST_SECONDS = 3;
     io::fsm<void> &fsm = co_await io::get_fsm;
+    co_await *fsm.spawn_now(nonblocking_benchmark());
     size_t exchange_count = 0;
     size_t byte_count = 0;
     io::fsm_handle<void> h = fsm.spawn_now(chan(&exchange_count, &byte_count));
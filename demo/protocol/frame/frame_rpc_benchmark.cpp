@@ -0,0 +1,213 @@
+#include <ioManager/ioManager.h>
+#include <ioManager/pipeline.h>
+#include <ioManager/rpc.h>
+#include <ioManager/timer.h>
+#include <ioManager/socket/asio/tcp.h>
+#include <ioManager/socket/asio/tcp_accp.h>
+#include <ioManager/protocol/http/http.h>
+#include <ioManager/protocol/frame.h>
+
+// Echo rpc over one connection: io::prot::frame (binary frames, many calls in flight)
+// against HTTP/1.1 (req_parser + io::rpc, one request at a time).
+// At 1 in flight both are bound by the same socket calls per round trip, expect them even: the frames win by multiplexing.
+constexpr uint16_t FRAME_PORT = 12360;
+constexpr uint16_t HTTP_PORT = 12361;
+constexpr size_t PAYLOAD_SIZE = 32;
+constexpr size_t TOTAL_CALLS = 200000;
+constexpr uint32_t ECHO_METHOD = 1;
+
+void print_result(const char* name, size_t calls, std::chrono::steady_clock::duration duration, std::chrono::steady_clock::duration latency_sum) {
+    double seconds = std::chrono::duration<double>(duration).count();
+    std::cout << name << ":" << std::endl;
+    std::cout << "  Calls: " << calls << ", total time: " << seconds << " s" << std::endl;
+    std::cout << "  Calls per second: " << static_cast<size_t>(calls / seconds) << std::endl;
+    std::cout << "  Average latency: " << std::chrono::duration_cast<std::chrono::nanoseconds>(latency_sum).count() / calls << " ns" << std::endl;
+}
+
+io::fsm_func<void> frame_server() {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    io::sock::tcp_accp acceptor(fsm);
+    if (!acceptor.bind_and_listen(asio::ip::tcp::endpoint(asio::ip::tcp::v4(), FRAME_PORT))) co_return;
+    while (1)
+    {
+        io::future_with<std::optional<io::sock::tcp>> accept_future;
+        acceptor >> accept_future;
+        co_await accept_future;
+        if (!accept_future.data.has_value())
+            co_return;
+        fsm.spawn_now(
+            [](io::sock::tcp socket) -> io::fsm_func<void>
+            {
+                io::fsm<void>& fsm = co_await io::get_fsm;
+                io::rpc<uint32_t, io::buf, io::buf> rpc(
+                    std::pair<uint32_t, io::rpc<uint32_t, io::buf, io::buf>::handler_type>{ ECHO_METHOD, [](io::buf payload) { return payload; } }
+                );
+                io::future end;
+                auto pipeline = io::pipeline<>() >> socket >> io::prot::frame::parser(fsm)
+                    >> io::prot::frame::server(fsm, [&rpc](uint32_t method, io::buf payload) { return rpc(method, std::move(payload)); })
+                    >> io::prot::frame::serializer(fsm) >> socket;
+                auto started = std::move(pipeline).spawn(fsm,
+                    [prom = fsm.make_future(end)](int which, bool output_or_input, std::error_code ec) mutable {
+                        prom.resolve_later();
+                    });
+                co_await end;
+            }(std::move(accept_future.data.value())))
+            .detach();
+    }
+}
+
+io::fsm_func<void> http_server() {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    io::sock::tcp_accp acceptor(fsm);
+    if (!acceptor.bind_and_listen(asio::ip::tcp::endpoint(asio::ip::tcp::v4(), HTTP_PORT))) co_return;
+    while (1)
+    {
+        io::future_with<std::optional<io::sock::tcp>> accept_future;
+        acceptor >> accept_future;
+        co_await accept_future;
+        if (!accept_future.data.has_value())
+            co_return;
+        fsm.spawn_now(
+            [](io::sock::tcp socket) -> io::fsm_func<void>
+            {
+                io::fsm<void>& fsm = co_await io::get_fsm;
+                io::rpc<std::string_view, io::prot::http::req_insitu&, io::prot::http::rsp> rpc(
+                    std::pair<std::string_view, io::rpc<std::string_view, io::prot::http::req_insitu&, io::prot::http::rsp>::handler_type>{
+                        "/echo", [](io::prot::http::req_insitu& req) {
+                            io::prot::http::rsp rsp;
+                            for (auto& fragment : req.body_fragments)
+                                rsp.body += fragment;
+                            return rsp;
+                        } }
+                );
+                io::future end;
+                auto pipeline = io::pipeline<>() >> socket >> io::prot::http::req_parser(fsm)
+                    >> [&rpc](io::prot::http::req_insitu& req) -> std::optional<io::prot::http::rsp> { return rpc(req.url, req); }
+                    >> io::prot::http::serializer(fsm) >> socket;
+                auto started = std::move(pipeline).spawn(fsm,
+                    [prom = fsm.make_future(end)](int which, bool output_or_input, std::error_code ec) mutable {
+                        prom.resolve_later();
+                    });
+                co_await end;
+            }(std::move(accept_future.data.value())))
+            .detach();
+    }
+}
+
+// window: calls in flight over the connection.
+io::future_fsm_func_ frame_client(size_t window) {
+    io::fsm<io::future>& fsm = co_await io::get_fsm;
+    io::sock::tcp socket(fsm);
+    co_await socket.connect(asio::ip::tcp::endpoint(asio::ip::address::from_string("127.0.0.1"), FRAME_PORT));
+
+    io::prot::frame::client client(fsm);
+    auto pipeline = io::pipeline<>() >> socket >> io::prot::frame::parser(fsm)
+        >> client >> io::prot::frame::serializer(fsm) >> socket;
+    auto started = std::move(pipeline).spawn(fsm,
+        [&client](int which, bool output_or_input, std::error_code ec) {
+            client.fail_all(ec);
+        });
+
+    size_t issued = 0;
+    size_t failed = 0;
+    std::chrono::steady_clock::duration latency_sum{};
+    io::timer::up timer;
+    timer.start();
+    std::vector<io::future_fsm_handle_> workers;
+    for (size_t i = 0; i < window; i++) {
+        workers.push_back(fsm.spawn_now([](io::prot::frame::client& client, size_t& issued, size_t& failed,
+            std::chrono::steady_clock::duration& latency_sum) -> io::future_fsm_func_ {
+                while (issued < TOTAL_CALLS) {
+                    issued++;
+                    io::buf payload(PAYLOAD_SIZE);
+                    std::memset(payload.data(), 'x', PAYLOAD_SIZE);
+                    payload.size_increase(PAYLOAD_SIZE);
+
+                    io::future_with<io::buf> result;
+                    auto begin = std::chrono::steady_clock::now();
+                    client.call(ECHO_METHOD, std::move(payload), result);
+                    co_await result;
+                    latency_sum += std::chrono::steady_clock::now() - begin;
+                    if (result.getErr() || result.data.size() != PAYLOAD_SIZE)
+                        failed++;
+                }
+                co_return;
+            }(client, issued, failed, latency_sum)));
+    }
+    for (auto& worker : workers)
+        co_await *worker;
+    auto duration = timer.lap();
+
+    std::string name = "frame rpc, " + std::to_string(window) + " in flight";
+    print_result(name.c_str(), TOTAL_CALLS, duration, latency_sum);
+    if (failed)
+        std::cout << "  Failed: " << failed << std::endl;
+    socket.close();
+    co_return;
+}
+
+io::future_fsm_func_ http_client() {
+    io::fsm<io::future>& fsm = co_await io::get_fsm;
+    io::sock::tcp socket(fsm);
+    co_await socket.connect(asio::ip::tcp::endpoint(asio::ip::address::from_string("127.0.0.1"), HTTP_PORT));
+
+    struct response_sink {
+        io::promise<> prom;
+        inline void operator<<(io::prot::http::rsp_insitu& rsp) { prom.resolve_later(); }
+    } sink;
+    auto pipeline = io::pipeline<>() >> socket >> io::prot::http::rsp_parser(fsm) >> sink;
+    auto started = std::move(pipeline).spawn(fsm);
+
+    std::string request = "POST /echo HTTP/1.1\r\nHost: 127.0.0.1\r\nContent-Length: " + std::to_string(PAYLOAD_SIZE) + "\r\n\r\n" +
+        std::string(PAYLOAD_SIZE, 'x');
+    std::chrono::steady_clock::duration latency_sum{};
+    io::timer::up timer;
+    timer.start();
+    for (size_t i = 0; i < TOTAL_CALLS; i++) {
+        io::buf buffer(std::span<const char>(request.data(), request.size()));
+        io::future response;
+        sink.prom = fsm.make_future(response);
+        auto begin = std::chrono::steady_clock::now();
+        co_await (socket << buffer);
+        co_await response;
+        latency_sum += std::chrono::steady_clock::now() - begin;
+    }
+    auto duration = timer.lap();
+
+    print_result("HTTP/1.1 + io::rpc, 1 in flight", TOTAL_CALLS, duration, latency_sum);
+    socket.close();
+    co_return;
+}
+
+io::fsm_func<void> frame_rpc_benchmark() {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    fsm.spawn_now(frame_server()).detach();
+    fsm.spawn_now(http_server()).detach();
+    co_await fsm.setTimeout(std::chrono::milliseconds(200));
+
+    while (1) {
+        {
+            io::future_fsm_handle_ h = fsm.spawn_now(http_client());
+            co_await *h;
+        }
+        for (size_t window : { 1, 64 }) {
+            io::future_fsm_handle_ h = fsm.spawn_now(frame_client(window));
+            co_await *h;
+        }
+        std::cout << std::endl;
+        co_await fsm.setTimeout(std::chrono::seconds(1));
+    }
+}
+
+int main()
+{
+    io::manager mngr;
+    mngr.async_spawn(frame_rpc_benchmark());
+
+    while (1)
+    {
+        mngr.drive();
+    }
+
+    return 0;
+}
@@ -20,14 +20,22 @@ io::fsm_func<void> http_rpc_demo() {
                 {
                     io::fsm<void>& fsm = co_await io::get_fsm;
 
-                    io::rpc<std::string_view, io::prot::http::req_insitu&, io::prot::http::rsp> rpc(
-                        std::pair{
-                            "/test",[](io::prot::http::req_insitu& req)->io::prot::http::rsp {
+                    io::rpc_router<io::prot::http::req_insitu&, io::prot::http::rsp> rpc(
+                        io::rpc<>::route{
+                            "GET", "/test", [](io::prot::http::req_insitu& req, io::route_params&)->io::prot::http::rsp {
                         io::prot::http::rsp rsp;
                         rsp.body = "Hello io::manager!";
                         return rsp;
                         }
                         },
+                        io::rpc<>::route{
+                            "GET", "/user/:id", [](io::prot::http::req_insitu& req, io::route_params& params)->io::prot::http::rsp {
+                        io::prot::http::rsp rsp;
+                        rsp.body = "Hello user ";
+                        rsp.body += params["id"];
+                        return rsp;
+                        }
+                        },
                         io::rpc<>::def{ [](io::prot::http::req_insitu& req)->io::prot::http::rsp {
                         io::prot::http::rsp rsp;
                         rsp.body = "Unknown request.";
@@ -39,7 +47,7 @@ io::fsm_func<void> http_rpc_demo() {
 
                     auto pipeline = io::pipeline<>() >> socket >> io::prot::http::req_parser(fsm) >> [&rpc](io::prot::http::req_insitu& req)->std::optional<io::prot::http::rsp> {
 						//std::cout << "Received request: " << req.method_name() << " " << req.url << std::endl;
-                        io::prot::http::rsp rsp = rpc(req.url, req);
+                        io::prot::http::rsp rsp = rpc(req.method_name(), req.url, req);
 						
                         rsp.status_code = 200;
                         rsp.status_message = "OK";
@@ -0,0 +1,100 @@
+#include <ioManager/ioManager.h>
+#include <ioManager/pipeline.h>
+#include <ioManager/timer.h>
+#include <ioManager/protocol/kcp/kcp.h>
+#include <ctime>
+
+// Sessions per core of prot::kcp: N kcp sessions on one manager, linked in memory in pairs.
+// Every pair sends a 64 bytes ping each second, the other side echoes it back.
+// All sessions are driven by the kcp_scheduler of the manager, the benchmark reports the cpu time it takes.
+constexpr size_t PING_SIZE = 64;
+constexpr auto PING_INTERVAL = std::chrono::seconds(1);
+constexpr auto MEASURE_TIME = std::chrono::seconds(3);
+
+struct kcp_pair {
+    io::prot::kcp_t a, b;
+    io::prot::kcp_send_t send_a, send_b;
+    io::prot::kcp_recv_t recv_a, recv_b;
+    size_t& echoed;
+
+    struct counter_t {
+        size_t& echoed;
+        inline void operator<<(std::string& data) { echoed++; }
+    } counter;
+
+    kcp_pair(io::manager* mngr, uint32_t conv, int interval, size_t& echoed)
+        :a(mngr, conv), b(mngr, conv),
+        send_a(a.getSend()), send_b(b.getSend()), recv_a(a.getRecv()), recv_b(b.getRecv()),
+        echoed(echoed), counter{ echoed } {
+        a.nodelay(1, interval, 2, 1);
+        b.nodelay(1, interval, 2, 1);
+    }
+};
+
+io::fsm_func<void> run_pair(std::unique_ptr<kcp_pair> p, std::chrono::milliseconds phase) {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    auto to_span = [](io::buf& packet) -> std::optional<std::span<const char>> { return std::span<const char>(packet.data(), packet.size()); };
+    auto echo = [](std::string& data) -> std::optional<std::span<const char>> { return std::span<const char>(data.data(), data.size()); };
+    auto started = (io::pipeline<>() >> p->send_a >> to_span >> p->recv_b >> echo >> p->send_b >> to_span >> p->recv_a >> p->counter).spawn(fsm);
+
+    char ping[PING_SIZE] = {};
+    co_await fsm.setTimeout(phase);
+    while (1) {
+        co_await (p->send_a << std::span<const char>(ping, PING_SIZE));
+        co_await fsm.setTimeout(PING_INTERVAL);
+    }
+}
+
+io::fsm_func<void> kcp_scheduler_benchmark() {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    std::mt19937 rng(1);
+
+    while (1) {
+        for (int interval : { 10, 100 }) {
+            for (size_t sessions : { 1000, 10000, 50000 }) {
+                size_t echoed = 0;
+                std::vector<io::fsm_handle<void>> pairs;
+                pairs.reserve(sessions / 2);
+                for (size_t i = 0; i < sessions / 2; i++) {
+                    auto p = std::make_unique<kcp_pair>(fsm.getManager(), (uint32_t)i, interval, echoed);
+                    pairs.push_back(fsm.spawn_now(run_pair(std::move(p), std::chrono::milliseconds(rng() % 1000))));
+                }
+                auto scheduler = io::prot::kcp_scheduler::get(fsm.getManager());
+                co_await fsm.setTimeout(std::chrono::seconds(1));    // warm up
+
+                size_t updates_begin = scheduler->updates();
+                size_t echoed_begin = echoed;
+                std::clock_t cpu_begin = std::clock();
+                io::timer::up timer;
+                timer.start();
+                co_await fsm.setTimeout(MEASURE_TIME);
+                double seconds = std::chrono::duration<double>(timer.lap()).count();
+                double cpu_seconds = double(std::clock() - cpu_begin) / CLOCKS_PER_SEC;
+                double load = cpu_seconds / seconds;
+
+                std::cout << "kcp interval " << interval << " ms, " << scheduler->size() << " sessions:" << std::endl;
+                // sessions kept on time by a full core: a session needs 1000 / interval updates per second.
+                double updates = (scheduler->updates() - updates_begin) / seconds;
+                std::cout << "  ikcp_update per second: " << static_cast<size_t>(updates)
+                    << ", echoes per second: " << static_cast<size_t>((echoed - echoed_begin) / seconds) << std::endl;
+                std::cout << "  CPU load: " << load * 100 << " %, sessions per core: " << static_cast<size_t>(updates * interval / 1000 / load) << std::endl;
+                scheduler.reset();
+                pairs.clear();
+            }
+        }
+        std::cout << std::endl;
+    }
+}
+
+int main()
+{
+    io::manager mngr;
+    mngr.async_spawn(kcp_scheduler_benchmark());
+
+    while (1)
+    {
+        mngr.drive();
+    }
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include <ioManager/ioManager.h>
+#include <ioManager/pipeline.h>
+#include <ioManager/timer.h>
+#include <ioManager/socket/asio/udp.h>
+#include <ioManager/protocol/kcp/kcp_server.h>
+
+// One kcp_server echoing on one udp port (one thread), against a client thread
+// running N kcp sessions through its own kcp_server. Every session keeps WINDOW messages in flight.
+// Between rounds the client drops its sessions, the server evicts them after IDLE_TIMEOUT.
+constexpr uint16_t PORT = 12370;
+constexpr size_t MESSAGE_SIZE = 64;
+constexpr size_t WINDOW = 4;
+constexpr auto IDLE_TIMEOUT = std::chrono::seconds(2);
+constexpr auto ROUND_TIME = std::chrono::seconds(5);
+constexpr int SOCKET_BUFFER_SIZE = 8 * 1024 * 1024;
+
+std::atomic<size_t> server_messages = 0;
+
+io::fsm_func<void> echo_server() {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    io::sock::udp socket(fsm);
+    if (!socket.bind(asio::ip::udp::endpoint(asio::ip::address_v4::any(), PORT))) {
+        std::cerr << "Failed to bind UDP socket to port " << PORT << std::endl;
+        co_return;
+    }
+    socket.set_option(asio::socket_base::receive_buffer_size(SOCKET_BUFFER_SIZE));
+    socket.set_option(asio::socket_base::send_buffer_size(SOCKET_BUFFER_SIZE));
+    io::prot::kcp_server::config cfg;
+    cfg.idle_timeout = IDLE_TIMEOUT;
+    io::prot::kcp_server server(fsm, socket, cfg);
+
+    // echo every message back to its session
+    auto started = (io::pipeline<>() >> server >> [](io::prot::kcp_server::message& msg) -> std::optional<io::prot::kcp_server::message> {
+        server_messages.fetch_add(1, std::memory_order_relaxed);
+        return std::move(msg);
+    } >> server).spawn(fsm);
+
+    size_t last_in = 0, last_out = 0;
+    while (1) {
+        co_await fsm.setTimeout(std::chrono::seconds(1));
+        std::cout << "  server: " << server.size() << " sessions, packets in " << server.packets_received() - last_in
+            << "/s, out " << server.packets_sent() - last_out << "/s, dropped " << server.packets_dropped() << std::endl;
+        last_in = server.packets_received();
+        last_out = server.packets_sent();
+    }
+}
+
+io::fsm_func<void> client() {
+    io::fsm<void>& fsm = co_await io::get_fsm;
+    io::sock::udp socket(fsm);
+    if (!socket.bind(asio::ip::udp::endpoint(asio::ip::address_v4::any(), 0))) {
+        std::cerr << "Failed to bind UDP socket" << std::endl;
+        co_return;
+    }
+    socket.set_option(asio::socket_base::receive_buffer_size(SOCKET_BUFFER_SIZE));
+    socket.set_option(asio::socket_base::send_buffer_size(SOCKET_BUFFER_SIZE));
+    io::prot::kcp_server::config cfg;
+    cfg.accept = false;
+    io::prot::kcp_server client(fsm, socket, cfg);
+    asio::ip::udp::endpoint server_endpoint(asio::ip::address::from_string("127.0.0.1"), PORT);
+
+    // send every echo back again
+    struct pong_t {
+        size_t received = 0;
+        inline void operator<<(io::prot::kcp_server::message& msg) {
+            received++;
+            msg.session->send(msg.data);
+        }
+    } pong;
+    auto started = (io::pipeline<>() >> client >> pong).spawn(fsm);
+
+    co_await fsm.setTimeout(std::chrono::milliseconds(200));
+    uint32_t conv = 1;
+    while (1) {
+        for (size_t sessions : { 100, 1000, 5000 }) {
+            std::vector<std::shared_ptr<io::prot::kcp_server::session>> list;
+            char message[MESSAGE_SIZE] = {};
+            for (size_t i = 0; i < sessions; i++) {
+                list.push_back(client.connect(conv++, server_endpoint));
+                for (size_t w = 0; w < WINDOW; w++)
+                    list.back()->send(std::span<const char>(message, MESSAGE_SIZE));
+            }
+            co_await fsm.setTimeout(std::chrono::seconds(1));    // warm up
+
+            size_t begin = pong.received;
+            size_t server_begin = server_messages.load();
+            io::timer::up timer;
+            timer.start();
+            co_await fsm.setTimeout(ROUND_TIME);
+            double seconds = std::chrono::duration<double>(timer.lap()).count();
+            std::cout << sessions << " sessions, " << WINDOW << " messages in flight each:" << std::endl;
+            std::cout << "  Round trips per second: " << static_cast<size_t>((pong.received - begin) / seconds)
+                << ", server messages per second: " << static_cast<size_t>((server_messages.load() - server_begin) / seconds) << std::endl;
+
+            for (auto& ses : list)
+                client.close(ses);
+            list.clear();
+            co_await fsm.setTimeout(IDLE_TIMEOUT * 2);    // the server evicts the sessions
+        }
+        std::cout << std::endl;
+    }
+}
+
+int main()
+{
+    std::thread server_thread([]() {
+        io::manager mngr;
+        mngr.async_spawn(echo_server());
+        while (1)
+        {
+            mngr.drive();
+        }
+    });
+
+    io::manager mngr;
+    mngr.async_spawn(client());
+
+    while (1)
+    {
+        mngr.drive();
+    }
+
+    return 0;
+}
@@ -50,7 +50,7 @@ io::fsm_func<void> kcp_echo_server() {
             return std::span<const char>(data.first.data(), data.first.size());
         } >> kcp_recv >> kcp_send >>
         // Adapter to convert KCP output to UDP format
-        [&client_endpoint](std::string& kcp_data) -> std::optional<std::pair<std::span<char>, asio::ip::udp::endpoint>> {
+        [&client_endpoint](io::buf& kcp_data) -> std::optional<std::pair<std::span<char>, asio::ip::udp::endpoint>> {
             try {
                 if constexpr (debuging)
                 std::cout << "    Server sending " << kcp_data.size() << " bytes back to client at " 
@@ -183,7 +183,7 @@ io::fsm_func<void> kcp_sentinel_client() {
             return std::span<const char>(data.data(), data.size());
         } >> kcp_send >>
         // Adapter to convert KCP output to UDP format with server endpoint
-        [server_endpoint](std::string& kcp_data) -> std::optional<std::pair<std::span<char>, asio::ip::udp::endpoint>> {
+        [server_endpoint](io::buf& kcp_data) -> std::optional<std::pair<std::span<char>, asio::ip::udp::endpoint>> {
             if constexpr (debuging)
             std::cout << "Client sending " << kcp_data.size() << " bytes to server at " 
                      << server_endpoint.address().to_string() << ":" << server_endpoint.port() << std::endl;
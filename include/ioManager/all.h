@@ -19,8 +19,12 @@
 #include "protocol/async_chan.h"
 #include "protocol/async_semaphore.h"
 #include "protocol/chan.h"
+#include "protocol/frame.h"
 #include "protocol/packet_sentinel.h"
 
 #include "protocol/kcp/kcp.h"
+#if IO_USE_ASIO
+#include "protocol/kcp/kcp_server.h"
+#endif
 #include "protocol/http/http.h"
 #include "protocol/mqtt/mqtt.h"
@@ -35,4 +35,8 @@
 
 #ifndef IO_USE_STACKFUL
 #define IO_USE_STACKFUL 1
+#endif
+
+#ifndef IO_USE_PIPELINE_STATS
+#define IO_USE_PIPELINE_STATS 0
 #endif
\ No newline at end of file
@@ -12,11 +12,22 @@ inline void io::lowlevel::awaiter::erase_this()
 }
 inline void io::lowlevel::awaiter::queue_in(await_queue* queue)
 {
+    manager* owner = mngr;      // once queued, the owner may settle and reuse this awaiter
     while (queue->lock.test_and_set());
     this->no_tm.queue_next = this;
     std::swap(this->no_tm.queue_next, queue->queue);
     queue->lock.clear();
-    mngr->suspend_release();
+    owner->suspend_release();
+}
+inline void io::lowlevel::awaiter::queue_local()
+{
+    this->no_tm.queue_next = nullptr;
+    if (mngr->resolve_queue_local_tail != nullptr)
+        mngr->resolve_queue_local_tail->no_tm.queue_next = this;
+    else
+        mngr->resolve_queue_local = this;
+    mngr->resolve_queue_local_tail = this;
+    // no wake up: drive() checks the queue before it suspends, and after every handler of io_ctx.
 }
 inline void io::lowlevel::awaiter::reset()
 {
@@ -28,6 +39,18 @@ inline void io::lowlevel::awaiter::reset()
     this->no_tm.err = std::error_code();
 };
 
+//wake_signal
+inline void io::lowlevel::wake_signal::set()
+{
+    if (waiting == nullptr)
+    {
+        pending = true;
+        return;
+    }
+    std::coroutine_handle<> h = std::exchange(waiting, nullptr);
+    *std::exchange(waiter_ref, nullptr) = nullptr;     // woken: its awaitable is done with the signal
+    fsm->mngr->resume_ready(h, *fsm);
+}
 
 
 //fsm_base
@@ -65,6 +88,15 @@ inline void io::lowlevel::fsm_base::make_outdated_clock(clock& fut, bool isResol
 {
     this->mngr->make_outdated_clock(fut, isResolve);
 }
+inline void io::lowlevel::fsm_base::make_ready_future(future& fut)
+{
+    this->mngr->make_ready_future(fut);
+}
+template <typename T_Duration>
+inline void io::lowlevel::fsm_base::make_periodic(periodic& fut, T_Duration period, periodic_mode mode)
+{
+    this->mngr->make_periodic(fut, period, mode);
+}
 inline io::async_promise io::lowlevel::fsm_base::make_future(async_future &fut)
 {
     return this->mngr->make_future(fut);
@@ -77,9 +109,7 @@ inline bool io::lowlevel::promise_base::resolve_later() {
     bool ret = false;
     if (valid())
     {
-        awaiter->no_tm.queue_next = awaiter;
-        std::swap(awaiter->no_tm.queue_next, awaiter->mngr->resolve_queue_local);
-        awaiter->mngr->suspend_release();
+        awaiter->queue_local();
         ret = true;
     }
     awaiter = nullptr;
@@ -90,9 +120,7 @@ inline bool io::lowlevel::promise_base::reject_later(std::error_code ec) {
     if (valid())
     {
         this->awaiter->no_tm.err = ec;
-        awaiter->no_tm.queue_next = awaiter;
-        std::swap(awaiter->no_tm.queue_next, awaiter->mngr->resolve_queue_local);
-        awaiter->mngr->suspend_release();
+        awaiter->queue_local();
         ret = true;
     }
     awaiter = nullptr;
@@ -106,9 +134,7 @@ inline bool io::lowlevel::promise_base::reject_later(std::string_view message)
         std::error_code ec(this->awaiter->mngr->errc_pool.assign(message), this->awaiter->mngr->errc_pool);
         this->awaiter->bit_set |= this->awaiter->has_dynamic_error;
         this->awaiter->no_tm.err = ec;
-        awaiter->no_tm.queue_next = awaiter;
-        std::swap(awaiter->no_tm.queue_next, awaiter->mngr->resolve_queue_local);
-        awaiter->mngr->suspend_release();
+        awaiter->queue_local();
         ret = true;
     }
     awaiter = nullptr;
@@ -122,9 +148,7 @@ inline bool io::lowlevel::promise_base::reject_later(std::string &&message)
         std::error_code ec(this->awaiter->mngr->errc_pool.assign(std::move(message)), this->awaiter->mngr->errc_pool);
         this->awaiter->bit_set |= this->awaiter->has_dynamic_error;
         this->awaiter->no_tm.err = ec;
-        awaiter->no_tm.queue_next = awaiter;
-        std::swap(awaiter->no_tm.queue_next, awaiter->mngr->resolve_queue_local);
-        awaiter->mngr->suspend_release();
+        awaiter->queue_local();
         ret = true;
     }
     awaiter = nullptr;
@@ -247,14 +271,20 @@ inline io::lowlevel::awaitable_base<T_FSM, returnTypeAsIndex, status, Args...>::
         {
             std::coroutine_handle<io::fsm_promise<T_FSM>> h;
             h = h.from_promise(this->f_p);
-            h.resume();
+            this->f_p._fsm.mngr->resume_ready(h, this->f_p._fsm);
         }
         };
     for (auto& i : await_arr)
     {
-        i->coro = &coro_set;
+        if ((i->bit_set & i->is_ready) == false)    // shared, other coroutines may await it meanwhile
+            i->coro = &coro_set;
     }
 }
+template <typename T_FSM, bool returnTypeAsIndex, io::lowlevel::selector_status status, typename ...Args>
+    requires (std::is_convertible_v<Args&, io::future&> && ...)
+inline std::coroutine_handle<> io::lowlevel::awaitable_base<T_FSM, returnTypeAsIndex, status, Args...>::await_suspend(std::coroutine_handle<>) {
+    return f_p._fsm.mngr->next_ready();
+}
 template <typename T_FSM, bool returnTypeAsIndex, io::lowlevel::selector_status status, typename ...Args>
     requires (std::is_convertible_v<Args&, io::future&> && ...)
 inline io::future_tag io::lowlevel::awaitable_base<T_FSM, returnTypeAsIndex, status, Args...>::await_resume() noexcept requires (!returnTypeAsIndex && sizeof...(Args) == 1 && !(std::is_convertible_v<Args&, io::clock&> && ...)) {
@@ -298,9 +328,90 @@ inline int io::lowlevel::awaitable_base<T_FSM, returnTypeAsIndex, status, Args..
 
 
 
+//migrate_awaitable
+template <typename T_FSM, size_t N>
+inline bool io::lowlevel::migrate_awaitable<T_FSM, N>::await_ready() {
+    if (target == nullptr || target == f_p._fsm.mngr)
+        return true;
+    allowed = false;
+    if (f_p._fsm.is_detached == false)
+        return true;
+    for (future* fut : futures)
+    {
+        awaiter* awa = fut->awaiter;
+        if (awa == nullptr)
+            continue;
+        if (awa->bit_set & awa->is_periodic)
+            return true;
+        // settled, and the promise side is gone: nothing will touch the awaiter but the future
+        if ((awa->bit_set & awa->set_lock) == false ||
+            ((awa->bit_set & awa->promise_handled) && (awa->bit_set & awa->is_ready) == false))
+            return true;
+    }
+    allowed = true;
+    return false;
+}
+template <typename T_FSM, size_t N>
+inline std::coroutine_handle<> io::lowlevel::migrate_awaitable<T_FSM, N>::await_suspend(std::coroutine_handle<> h) {
+    manager* from = f_p._fsm.mngr;
+    for (size_t i = 0; i < N; i++)
+    {
+        awaiter* awa = futures[i]->awaiter;
+        if (awa == nullptr)
+            continue;
+        settled& out = outcomes[i];
+        out.empty = false;
+        out.bits = awa->bit_set & (awa->is_clock | awa->clock_resolve | awa->is_ready | awa->has_dynamic_error);
+        if ((awa->bit_set & awa->is_clock) == false)    // a clock has no error code: tm shares its storage.
+        {
+            out.err = awa->no_tm.err;
+            if (awa->bit_set & awa->has_dynamic_error)
+                out.message = out.err.message();
+        }
+        futures[i]->invalidate();
+    }
+    std::coroutine_handle<> next = from->next_ready();
+    // the coroutine may run on the target before this returns: nothing of it is touched after the push.
+    target->push_task(from->make_task([this, h]() { this->arrive(h); }));
+    return next;
+}
+template <typename T_FSM, size_t N>
+inline void io::lowlevel::migrate_awaitable<T_FSM, N>::arrive(std::coroutine_handle<> h) {
+    for (size_t i = 0; i < N; i++)
+    {
+        settled& out = outcomes[i];
+        if (out.empty)
+            continue;
+        future& fut = *futures[i];
+        if (out.bits & awaiter::is_ready)
+        {
+            target->make_ready_future(fut);
+            continue;
+        }
+        target->FutureVaild(fut);
+        awaiter* awa = fut.awaiter;
+        awa->bit_set = awa->future_handled | awa->occupy_lock | awa->set_lock | (out.bits & ~awa->has_dynamic_error);
+        if (out.bits & awa->is_clock)
+            continue;
+        if (out.bits & awa->has_dynamic_error)
+        {
+            awa->no_tm.err = std::error_code(target->errc_pool.assign(std::move(out.message)), target->errc_pool);
+            awa->bit_set |= awa->has_dynamic_error;
+        }
+        else
+        {
+            awa->no_tm.err = out.err;
+        }
+    }
+    f_p._fsm.mngr = target;
+    h.resume();
+}
+
+
+
 //future
 inline void io::future::decons() noexcept {
-    if (this->awaiter) {
+    if (this->awaiter && (this->awaiter->bit_set & this->awaiter->is_ready) == false) {    // the ready awaiter is shared, it's left alone
         if ((this->awaiter->bit_set & this->awaiter->promise_handled) == false &&
             this->awaiter->coro == nullptr)
             this->awaiter->erase_this();
@@ -380,6 +491,19 @@ inline bool io::clock::set_later() {
 
 
 
+//periodic
+inline void io::periodic::decons() noexcept {
+    if (this->awaiter) {
+        if ((this->awaiter->bit_set & this->awaiter->is_periodic) &&
+            this->awaiter->coro == nullptr)
+        {
+            this->awaiter->bit_set &= ~(this->awaiter->promise_handled | this->awaiter->is_periodic);
+            this->awaiter->mngr->time_chain.erase(this->awaiter->tm);
+        }
+    }
+}
+
+
 //timer
 //inline void io::timer::reset(
 //    mode_t mode,
@@ -479,7 +603,7 @@ inline bool io::future::rethrow(io::lowlevel::promise_base& prom_base) {
 
 //manager
 template <typename Func, typename ...Args>
-inline io::async_future io::manager::post(pool& thread_pool, Func func, Args&&... args)
+inline auto io::manager::post(pool& thread_pool, Func func, Args&&... args)
 {
 	return thread_pool.post(this, func, std::forward<Args>(args)...);
 }
\ No newline at end of file
@@ -7,17 +7,19 @@
 																	friend struct io::async_promise;\
 																	template <typename T2>requires (!std::is_same_v<T2, void>)friend struct io::future_with;\
 																	friend struct io::clock;\
+																	friend struct io::periodic;\
 																	template <typename T2>friend struct io::promise;\
 																	template <typename T2>friend struct io::fsm;\
 																	template <typename T2>requires (std::is_same_v<T2, void> || std::is_default_constructible_v<T2>)friend struct io::fsm_func;\
 																	template <typename T2>friend struct io::fsm_handle;\
 																	friend struct io::manager;\
+																	friend struct io::pool;\
                                                                     template <typename T2> friend struct dynamic_combinator;\
 																	friend struct io::sock::tcp;\
 																	friend struct io::sock::tcp_accp;\
 																	friend struct io::sock::udp;\
-																	template <typename Rear2, typename Front2, typename Adaptor2>friend struct io::pipeline_constructor;\
-																	template <typename Rear2, typename Front2, typename Adaptor2>friend struct io::pipeline;\
+																	template <typename Rear2, typename Front2, typename Adaptor2, size_t Depth2>friend struct io::pipeline_constructor;\
+																	template <typename Rear2, typename Front2, typename Adaptor2, size_t Depth2>friend struct io::pipeline;\
 																	template <typename Pipeline2, bool individual_coro2, typename ErrorHandler2>friend class pipeline_started;\
 																	template <typename FSM_Index2, typename FSM_In2, typename FSM_Out2>friend struct io::rpc;\
                                                                     template <typename T_spawn2> friend fsm_handle<T_spawn2> spawn_now(fsm_func<T_spawn2> new_fsm);\
@@ -25,6 +27,8 @@
 																	template <typename Func2, typename... Args2> friend void io::minicoro_detail::stackful_coro_entry(mco_coro* co);\
 																	template <typename Func2, typename... Args2> friend bool io::stackful::spawn_stacksize(size_t stack_size, Func2&& func, Args2 &&...args);\
 																	template <typename T2> friend io::future_tag io::stackful::await(T2&& fut);\
+																	template <template <bool, typename...> typename Selector2, bool returnTypeAsIndex2, typename... Args2> friend std::conditional_t<returnTypeAsIndex2, int, io::future_tag> io::stackful::await(Selector2<returnTypeAsIndex2, Args2...>&& sel);\
+																	friend io::stackful::stack_pool &io::stackful::stacks();\
 
 //-------------------------------------------------------------------------------------------------------------------------------------------------------------------
 template <typename T, size_t batch_size>struct hive;
@@ -38,8 +42,16 @@ struct future_with;
 struct awaitable;
 struct future;
 struct clock;
+struct periodic;
+// how a periodic clock picks its next deadline
+enum class periodic_mode {
+	fixed_rate = 0,		// start + n * period. Periods the manager was too late for are skipped and counted as missed.
+	fixed_delay = 1		// one period after the tick fired
+};
 template <typename T>struct promise;
 struct async_future;
+template <typename T>
+struct async_future_with;
 struct async_promise;
 template <typename T>struct fsm;
 template <typename T>
@@ -51,12 +63,13 @@ template <typename T>
 struct dynamic_combinator;
 struct pool;
 struct yield_t;
-template <typename Front, typename Rear, typename Adaptor>struct pipeline_constructor;
-template <typename Front, typename Rear, typename Adaptor>struct pipeline;
+template <typename Front, typename Rear, typename Adaptor, size_t Depth>struct pipeline_constructor;
+template <typename Front, typename Rear, typename Adaptor, size_t Depth>struct pipeline;
 template <typename Pipeline, bool individual_coro, typename ErrorHandler>class pipeline_started;
 template <typename key, typename req, typename rsp>struct rpc;
 
 manager* this_manager();
+std::chrono::steady_clock::time_point now();
 void drive();
 promise<void> make_future(future& fut);
 #if IO_USE_ASIO
@@ -73,7 +86,10 @@ promise<T_Prom> make_future(future& fut, T_Prom* mem_bind);
 template <typename T_Duration>
 void make_clock(clock& fut, T_Duration duration, bool isResolve = false);
 void make_outdated_clock(clock& fut, bool isResolve = false);
+template <typename T_Duration>
+void make_periodic(periodic& fut, T_Duration period, periodic_mode mode = periodic_mode::fixed_rate);
 async_promise make_future(async_future& fut);
+void make_ready_future(future& fut);
 
 #define IO_MANAGER_FORWARD_FUNC(___obj___,___func___) template <typename ...Args> auto ___func___(Args&&...args) { return ___obj___.___func___(std::forward<Args>(args)...); }
 
@@ -104,9 +120,13 @@ namespace minicoro_detail {
 	void stackful_coro_entry(mco_coro* co);
 }
 namespace stackful {
+    struct stack_pool;
+    stack_pool &stacks();
     template <typename Func, typename... Args>
     bool spawn_stacksize(size_t stack_size, Func &&func, Args &&...args);
     template <typename T>
 	io::future_tag await(T&& fut);
+    template <template <bool, typename...> typename Selector, bool returnTypeAsIndex, typename... Args>
+	std::conditional_t<returnTypeAsIndex, int, io::future_tag> await(Selector<returnTypeAsIndex, Args...>&& sel);
 }
 #endif
\ No newline at end of file
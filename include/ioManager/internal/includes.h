@@ -18,13 +18,17 @@
 #include <cstdint>
 #include <cstring>
 #include <chrono>
+#include <time.h>
 #include <thread>
 #include <mutex>
 #include <stack>
 #include <optional>
 #include <list>
+#include <vector>
 #include <atomic>
 #include <format>
+#include <bit>
+#include <array>
 //_MSC_FULL_VER
 /**
  * Disable optimization for coroutine header in MSVC to prevent crashes.
@@ -49,6 +53,10 @@
 #include <algorithm>
 #include <type_traits>
 #include <functional>
+#if defined(__linux__)
+#include <sched.h>
+#include <pthread.h>
+#endif
 #include "selectMarco.h"
 
 #if IO_USE_ASIO
@@ -93,4 +101,14 @@
 #if IO_USE_STACKFUL
 #define MINICORO_IMPL
 #include "../minicoro/minicoro.h"
+// guard pages of stackful stacks
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 #endif
\ No newline at end of file
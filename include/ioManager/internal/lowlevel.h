@@ -2,6 +2,7 @@ class lowlevel {
     __IO_INTERNAL_HEADER_PERMISSION
 
     friend manager* this_manager();
+    friend std::chrono::steady_clock::time_point now();
     friend void drive();
     friend promise<void> make_future(future& fut);
 #if IO_USE_ASIO
@@ -18,7 +19,10 @@ class lowlevel {
     template <typename T_Duration>
     friend void make_clock(clock& fut, T_Duration duration, bool isResolve);
     friend void make_outdated_clock(clock& fut, bool isResolve);
+    template <typename T_Duration>
+    friend void make_periodic(periodic& fut, T_Duration period, periodic_mode mode);
     friend async_promise make_future(async_future& fut);
+    friend void make_ready_future(future& fut);
 
     inline thread_local static manager *this_thread = nullptr;
 
@@ -27,6 +31,15 @@ class lowlevel {
         lowlevel::awaiter* queue = nullptr;
         std::atomic_flag lock = ATOMIC_FLAG_INIT;
     };
+    // a plain callable posted to a manager, run once by its drive() without a coroutine frame.
+    // The node belongs to the manager that posted it, and goes back to it after the run. See manager::post.
+    struct task {
+        static constexpr size_t inline_size = 64;       // larger callables are stored on the heap
+        task* next;
+        manager* owner;
+        bool (*invoke)(task* self, bool run);           // runs the callable if run, then destroys it. true: it took care of the node
+        alignas(std::max_align_t) unsigned char storage[inline_size];
+    };
     struct awaiter {
         static constexpr int promise_handled = 1 << 0;
         static constexpr int future_handled = 1 << 1;
@@ -35,22 +48,32 @@ class lowlevel {
         static constexpr int is_clock = 1 << 4;
         static constexpr int clock_resolve = 1 << 5;    // clock treated as resolve, rather than default reject.
         static constexpr int has_dynamic_error = 1 << 6;
+        static constexpr int is_periodic = 1 << 7;      // periodic clock, re-armed by the manager. set_lock marks a pending tick.
+        static constexpr int fixed_delay = 1 << 8;      // periodic clock in periodic_mode::fixed_delay
+        static constexpr int is_ready = 1 << 9;         // the resolved awaiter a manager shares among ready futures, see make_ready_future
         static constexpr int initilaze = promise_handled | future_handled;
 
-        int bit_set = initilaze;
-
+        // 40 bytes on 64 bit platforms, the hive allocates them one by one: a 48 byte block of malloc.
         std::function<void(awaiter*)>* coro = nullptr;    //lambda type erasure. (virtual)
+        manager* mngr;
 
         union {
             std::multimap<std::chrono::steady_clock::time_point, awaiter*>::iterator tm;
             struct {
-                std::error_code err;
+                compact_error err;
                 awaiter* queue_next;
             } no_tm;
+            struct {
+                std::multimap<std::chrono::steady_clock::time_point, awaiter*>::iterator tm;    // the same as tm
+                std::chrono::steady_clock::duration period;
+            } tm_periodic;
         };
-        manager* mngr;
+
+        int bit_set = initilaze;
+        uint32_t missed;        // periodic clock only, saturating
         inline void erase_this();
         inline void queue_in(await_queue* queue);
+        inline void queue_local();      // to resolve_queue_local of mngr, on its own thread
         inline awaiter() {
             this->no_tm.err = std::error_code();
         }
@@ -61,6 +84,11 @@ class lowlevel {
             if (coro)
                 std::invoke(*coro, this);
         }
+        // an await on a periodic clock completed, its pending tick is taken.
+        inline void take_tick() {
+            if (this->bit_set & is_periodic)
+                this->bit_set &= ~set_lock;
+        }
     };
     struct promise_base {
         __IO_INTERNAL_HEADER_PERMISSION
@@ -157,6 +185,11 @@ class lowlevel {
         template <typename T_Duration>
         io::clock setTimeout(T_Duration duration, bool isResolve = false);
         inline void make_outdated_clock(io::clock& fut, bool isResolve = false);
+        // make a future that is already resolved, without allocating
+        inline void make_ready_future(io::future& fut);
+        // make a periodic clock, re-armed by the manager on every tick
+        template <typename T_Duration>
+        void make_periodic(io::periodic& fut, T_Duration period, periodic_mode mode = periodic_mode::fixed_rate);
         // make async future pair
         async_promise make_future(async_future &fut);
         // sync co_spawn, run coroutine immediately.
@@ -202,6 +235,60 @@ class lowlevel {
         std::coroutine_handle<>* ptr;
         bool* simple_awaiter;
     };
+    template <typename T_FSM>
+    struct wake_awaitable;
+    // a wake-up one coroutine awaits over and over, re-armed in place: no awaiter and no std::function per wait.
+    //  set() resumes the coroutine waiting on it, or keeps it pending for the next co_await. Same thread only.
+    struct wake_signal {
+        inline wake_signal() = default;
+        wake_signal(const wake_signal&) = delete;
+        wake_signal& operator=(const wake_signal&) = delete;
+        inline wake_signal(wake_signal&& right) noexcept : pending(right.pending) { IO_ASSERT(right.waiting == nullptr, "moving a wake signal that is awaited!"); }
+        inline wake_signal& operator=(wake_signal&& right) noexcept {
+            IO_ASSERT(waiting == nullptr && right.waiting == nullptr, "moving a wake signal that is awaited!");
+            pending = right.pending;
+            return *this;
+        }
+        inline ~wake_signal() {
+            if (waiter_ref != nullptr)      // gone before the coroutine waiting on it: its awaitable mustn't touch it
+                *waiter_ref = nullptr;
+        }
+        void set();
+        bool pending = false;
+    private:
+        template <typename T_FSM>
+        friend struct wake_awaitable;
+        std::coroutine_handle<> waiting = nullptr;
+        fsm_base* fsm = nullptr;
+        wake_signal** waiter_ref = nullptr;
+    };
+    template <typename T_FSM>
+    struct wake_awaitable {
+        fsm_func<T_FSM>::promise_type& f_p;
+        wake_signal* signal;
+        inline wake_awaitable(fsm_func<T_FSM>::promise_type& _fsm, wake_signal& sig) : f_p(_fsm), signal(&sig) {}
+        wake_awaitable(const wake_awaitable&) = delete;
+        inline bool await_ready() noexcept { return std::exchange(signal->pending, false); }
+        inline std::coroutine_handle<> await_suspend(std::coroutine_handle<> h) {
+            signal->waiting = h;
+            signal->fsm = &f_p._fsm;
+            signal->waiter_ref = &signal;
+            f_p._fsm.is_awaiting = true;
+            return f_p._fsm.mngr->next_ready();
+        }
+        // an int like the race_index it replaces
+        inline int await_resume() noexcept {
+            f_p._fsm.is_awaiting = false;
+            return 0;
+        }
+        inline ~wake_awaitable() {
+            if (signal != nullptr)          // destroyed while waiting: a later set() mustn't resume it
+            {
+                signal->waiting = nullptr;
+                signal->waiter_ref = nullptr;
+            }
+        }
+    };
     template <typename T_spawn>
     struct awa_initial_suspend {
         io::fsm<T_spawn>* _pthis;
@@ -221,6 +308,29 @@ class lowlevel {
             }
         }
     };
+    // co_await io::migrate_to. The coroutine is handed to the target in a task node of its manager.
+    template <typename T_FSM, size_t N>
+    struct migrate_awaitable {
+        // a settled future on its way: the awaiter stays behind, the target makes a new one with the same outcome
+        struct settled {
+            bool empty = true;
+            int bits = 0;
+            std::error_code err;
+            std::string message;    // a dynamic error's message: its pool belongs to the old manager
+        };
+        fsm_func<T_FSM>::promise_type& f_p;
+        manager* target;
+        std::array<future*, N> futures;
+        std::array<settled, N> outcomes;
+        bool allowed = true;
+        inline migrate_awaitable(fsm_func<T_FSM>::promise_type& _fsm, manager* to, const std::array<future*, N>& futs)
+            : f_p(_fsm), target(to), futures(futs) {}
+        bool await_ready();
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> h);
+        inline bool await_resume() noexcept { return allowed; }
+    private:
+        void arrive(std::coroutine_handle<> h);
+    };
     enum class selector_status {
         //not_await = 0,      //condition has been fulfilled. not await.
         all = 1,            //all resolve or any reject
@@ -246,7 +356,8 @@ class lowlevel {
 
         inline bool coro_set_base(awaiter* awa) // returns true to fulfill
         {
-            bool isReject = (awa->bit_set & awa->is_clock && (awa->bit_set & awa->clock_resolve) == false) || awa->no_tm.err.operator bool();
+            // a clock has no error code: tm shares its storage.
+            bool isReject = (awa->bit_set & awa->is_clock) ? (awa->bit_set & awa->clock_resolve) == false : awa->no_tm.err.operator bool();
             auto findWhoEnd = [&] {
                 for (int i = 0; i < sizeof...(Args); i++)
                 {
@@ -322,7 +433,7 @@ class lowlevel {
         }
         awaitable_base(fsm_func<T_FSM>::promise_type& _fsm, std::array<awaiter*, sizeof...(Args)>&& il);
         inline bool await_ready() noexcept { return when_all_count == 0; }
-        inline void await_suspend(std::coroutine_handle<> h) {}
+        inline std::coroutine_handle<> await_suspend(std::coroutine_handle<> h);
         inline future_tag await_resume() noexcept requires (!returnTypeAsIndex && sizeof...(Args) == 1 && !(std::is_convertible_v<Args&, io::clock&> && ...));
         inline future_tag await_resume() noexcept requires (!returnTypeAsIndex && sizeof...(Args) == 1 && (std::is_convertible_v<Args&, io::clock&> && ...));
         inline future_tag await_resume() noexcept requires (!returnTypeAsIndex && sizeof...(Args) >= 2 && status == selector_status::allsettle);
@@ -348,6 +459,7 @@ class lowlevel {
                         continue;
                     }
                 }
+                awa->take_tick();
                 awa->coro = nullptr;
             }
             f_p._fsm.is_awaiting = false;
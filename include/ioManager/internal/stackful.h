@@ -18,17 +18,22 @@ namespace io
             {
                 io::this_manager()->current_stackful = co;
                 auto *ctx = reinterpret_cast<stackful_context<Func, Args...> *>(mco_get_user_data(co));
+                // the context is on the spawner's stack, which is gone after the first suspension.
+                std::decay_t<Func> func(std::forward<Func>(ctx->func_ptr));
+                std::tuple<Args...> args(std::move(ctx->args_ptr));
+
                 if constexpr (sizeof...(Args) == 0)
                 {
-                    (ctx->func_ptr)();
+                    func();
                 }
                 else
                 {
-                    std::apply(std::forward<Func>(ctx->func_ptr), std::forward<std::tuple<Args...>>(ctx->args_ptr));
+                    std::apply(std::move(func), std::move(args));
                 }
-                io::this_manager()->stackful_deconstruct.push(co);
             }
 
+            // a coroutine cannot free its own stack: the resumer destroys it once it returned,
+            // so the stack goes back to the manager's pool while it is still warm.
             inline void resume(mco_coro *co)
             {
                 if (co && mco_status(co) == MCO_SUSPENDED)
@@ -36,6 +41,8 @@ namespace io
                     mco_coro *previous = io::this_manager()->current_stackful;
                     mco_resume(co);
                     io::this_manager()->current_stackful = previous;
+                    if (mco_status(co) == MCO_DEAD)
+                        mco_destroy(co);
                 }
             }
         }
@@ -55,6 +62,10 @@ namespace io
                 );
 
                 desc.user_data = &ctx;
+                // a finished coroutine is destroyed by its resumer in minicoro_detail::resume, its stack goes back to the pool of the manager
+                desc.alloc_cb = stack_pool::alloc;
+                desc.dealloc_cb = stack_pool::dealloc;
+                desc.allocator_data = io::this_manager()->stackful_stacks.allocator_data();
 
                 mco_coro *co = nullptr;
                 if (mco_create(&co, &desc) != MCO_SUCCESS)
@@ -70,33 +81,150 @@ namespace io
                     return false;
                 }
                 io::this_manager()->current_stackful = previous;
+                if (mco_status(co) == MCO_DEAD)
+                    mco_destroy(co);
                 return true;
             }
 
+            // stack pool of the current manager
+            inline stack_pool &stacks()
+            {
+                return io::this_manager()->stackful_stacks;
+            }
+
             template <typename Func, typename... Args>
             inline bool spawn(Func &&func, Args &&...args)
             {
                 return spawn_stacksize(0, std::forward<Func>(func), std::forward<Args>(args)...);
             }
 
+            // The wake callbacks live on the awaiting coroutine's own stack, next to the frame it resumes into.
+            // std::function only holds a std::reference_wrapper to them, which the standard requires to be
+            // stored without throwing, i.e. without allocating.
             template <typename T>
             inline io::future_tag await(T&& fut)
             {
                 if (fut.awaiter->bit_set & fut.awaiter->set_lock)
+                {
+                    fut.awaiter->take_tick();
                     return fut;
+                }
 
                 mco_coro *previous = io::this_manager()->current_stackful;
-                std::function<void(lowlevel::awaiter *)> coro_set = [previous](lowlevel::awaiter *awa)
+                auto wake = [previous](lowlevel::awaiter *)
                 {
                     minicoro_detail::resume(previous);
                 };
+                std::function<void(lowlevel::awaiter *)> coro_set = std::ref(wake);
                 fut.awaiter->coro = &coro_set;
                 mco_yield(previous);
                 fut.awaiter->coro = nullptr;
+                fut.awaiter->take_tick();
                 io::this_manager()->current_stackful = previous;
 
                 return fut;
             }
+
+            // io::future::all / any / race / allSettle and their _index variants, same results as co_await in a fsm_func.
+            template <template <bool, typename...> typename Selector, bool returnTypeAsIndex, typename... Args>
+            inline std::conditional_t<returnTypeAsIndex, int, io::future_tag> await(Selector<returnTypeAsIndex, Args...>&& sel)
+            {
+                using status_t = lowlevel::selector_status;
+                using selector_t = Selector<returnTypeAsIndex, Args...>;
+                constexpr status_t status = std::is_same_v<selector_t, lowlevel::all<returnTypeAsIndex, Args...>> ? status_t::all
+                    : std::is_same_v<selector_t, lowlevel::any<returnTypeAsIndex, Args...>> ? status_t::any
+                    : std::is_same_v<selector_t, lowlevel::race<returnTypeAsIndex, Args...>> ? status_t::race
+                    : status_t::allsettle;
+
+                // the same bookkeeping as lowlevel::awaitable_base::coro_set_base
+                uint32_t when_all_count = sizeof...(Args);
+                int which = -1;
+                lowlevel::awaiter *who = nullptr;
+                auto settle = [&](lowlevel::awaiter *awa) -> bool // returns true to fulfill
+                {
+                    bool isReject = (awa->bit_set & awa->is_clock) ? (awa->bit_set & awa->clock_resolve) == false : awa->no_tm.err.operator bool();
+                    auto findWhoEnd = [&]
+                    {
+                        for (int i = 0; i < (int)sizeof...(Args); i++)
+                        {
+                            if (sel.il[i] == awa)
+                            {
+                                which = i;
+                                who = awa;
+                                return true;
+                            }
+                        }
+                        IO_ASSERT(false, "awaiter mismatch!");
+                        return true;
+                    };
+                    auto whenAll = [&]
+                    {
+                        return --when_all_count == 0;
+                    };
+                    if constexpr (status == status_t::all)
+                        return isReject ? findWhoEnd() : whenAll();
+                    else if constexpr (status == status_t::any)
+                        return isReject ? whenAll() : findWhoEnd();
+                    else if constexpr (status == status_t::race)
+                        return findWhoEnd();
+                    else
+                        return whenAll();
+                };
+
+                bool fulfilled = false;
+                for (auto &awa : sel.il)
+                {
+                    if ((awa->bit_set & awa->set_lock) && settle(awa))
+                    {
+                        fulfilled = true;
+                        break;
+                    }
+                }
+
+                if (!fulfilled)
+                {
+                    mco_coro *previous = io::this_manager()->current_stackful;
+                    auto wake = [&settle, previous](lowlevel::awaiter *awa)
+                    {
+                        if (settle(awa))
+                            minicoro_detail::resume(previous);
+                    };
+                    std::function<void(lowlevel::awaiter *)> coro_set = std::ref(wake);
+                    for (auto &awa : sel.il)
+                    {
+                        if ((awa->bit_set & awa->is_ready) == false)
+                            awa->coro = &coro_set;
+                    }
+                    mco_yield(previous);
+                    io::this_manager()->current_stackful = previous;
+                }
+
+                // release the futures the way ~awaitable_base does
+                for (auto &awa : sel.il)
+                {
+                    if ((awa->bit_set & awa->future_handled) == false)
+                    {
+                        if ((awa->bit_set & awa->promise_handled) == false)
+                        {
+                            awa->erase_this();
+                            continue;
+                        }
+                        else if ((awa->bit_set & awa->is_clock) && (awa->bit_set & awa->set_lock) == false)
+                        {
+                            awa->mngr->time_chain.erase(awa->tm);
+                            awa->erase_this();
+                            continue;
+                        }
+                    }
+                    awa->take_tick();
+                    awa->coro = nullptr;
+                }
+
+                if constexpr (returnTypeAsIndex)
+                    return which;
+                else
+                    return io::future_tag(who);
+            }
         }
     }
 }
\ No newline at end of file
@@ -381,6 +381,70 @@ namespace io
             char* _owned;          // Whether this buffer owns the memory
         };
 
+        //type erasure callable with in-place storage, move only.
+        // Never allocates: a callable larger than the capacity is rejected at compile time.
+        template <typename Signature, size_t capacity = 4 * sizeof(void*)>
+        struct inplace_function;
+
+        template <typename R, typename ...Args, size_t capacity>
+        struct inplace_function<R(Args...), capacity> {
+            inline inplace_function() noexcept {}
+            inline inplace_function(std::nullptr_t) noexcept {}
+            template <typename F>
+                requires (!std::is_same_v<std::decay_t<F>, inplace_function> &&
+                    std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+            inline inplace_function(F&& f) {
+                using T = std::decay_t<F>;
+                static_assert(sizeof(T) <= capacity, "inplace_function ERROR: callable is larger than the in-place capacity.");
+                static_assert(alignof(T) <= alignof(std::max_align_t), "inplace_function ERROR: callable is over-aligned.");
+                new (storage) T(std::forward<F>(f));
+                table = &table_of<T>;
+            }
+            inline inplace_function(inplace_function&& right) noexcept : table(right.table) {
+                if (table)
+                    table->move(storage, right.storage);
+                right.table = nullptr;
+            }
+            inline inplace_function& operator=(inplace_function&& right) noexcept {
+                if (this != &right) {
+                    decons();
+                    table = right.table;
+                    if (table)
+                        table->move(storage, right.storage);
+                    right.table = nullptr;
+                }
+                return *this;
+            }
+            inplace_function(const inplace_function&) = delete;
+            inplace_function& operator=(const inplace_function&) = delete;
+            inline ~inplace_function() {
+                decons();
+            }
+            inline R operator()(Args... args) {
+                return table->invoke(storage, std::forward<Args>(args)...);
+            }
+            inline explicit operator bool() const noexcept { return table != nullptr; }
+        private:
+            struct vtable {
+                R(*invoke)(void*, Args&&...);
+                void(*move)(void* dst, void* src);
+                void(*destroy)(void*);
+            };
+            template <typename T>
+            inline static constexpr vtable table_of = {
+                [](void* p, Args&&... args) -> R { return std::invoke(*static_cast<T*>(p), std::forward<Args>(args)...); },
+                [](void* dst, void* src) { new (dst) T(std::move(*static_cast<T*>(src))); static_cast<T*>(src)->~T(); },
+                [](void* p) { static_cast<T*>(p)->~T(); }
+            };
+            inline void decons() noexcept {
+                if (table)
+                    table->destroy(storage);
+                table = nullptr;
+            }
+            const vtable* table = nullptr;
+            alignas(std::max_align_t) unsigned char storage[capacity];
+        };
+
 #include "internal/inplaceVector.h"
 
         template<typename>
@@ -392,9 +456,71 @@ namespace io
         template<typename T>
         struct is_future { static constexpr bool value = (io::is_future_with<T>::value || std::is_same_v<T, io::future>); };
 
+        // std::error_code in 8 bytes, for the awaiter: the value, and the index of its category in a process wide table.
+        // Categories are registered on first use. A category that is destroyed, such as a manager's dynamic_errc, forgets its index.
+        struct compact_error {
+            inline compact_error() {}
+            inline compact_error(const std::error_code& ec) : code(ec.value()), category(ec ? index_of(ec.category()) : 0) {}
+            inline operator std::error_code() const {
+                if (code == 0)
+                    return std::error_code();
+                return std::error_code(code, *categories[category].load(std::memory_order_relaxed));
+            }
+            inline explicit operator bool() const { return code != 0; }
+            inline int value() const { return code; }
+
+            static inline void forget(const std::error_category& cat) {
+                std::lock_guard<std::mutex> guard(category_lock);
+                uint32_t count = category_count.load(std::memory_order_relaxed);
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    if (categories[i].load(std::memory_order_relaxed) == &cat)
+                        categories[i].store(nullptr, std::memory_order_relaxed);
+                }
+            }
+        private:
+            int32_t code = 0;
+            uint32_t category = 0;
+
+            static constexpr uint32_t max_categories = 256;
+            inline static std::atomic<const std::error_category*> categories[max_categories] = {};
+            inline static std::atomic<uint32_t> category_count = 0;
+            inline static std::mutex category_lock;
+
+            // a handful of categories in a process: a scan, the lock only for a new one.
+            static inline uint32_t index_of(const std::error_category& cat) {
+                uint32_t count = category_count.load(std::memory_order_acquire);
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    if (categories[i].load(std::memory_order_relaxed) == &cat)
+                        return i;
+                }
+                std::lock_guard<std::mutex> guard(category_lock);
+                count = category_count.load(std::memory_order_relaxed);
+                uint32_t vacant = count;
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    const std::error_category* registered = categories[i].load(std::memory_order_relaxed);
+                    if (registered == &cat)
+                        return i;
+                    if (registered == nullptr && vacant == count)
+                        vacant = i;
+                }
+                if (vacant == count)
+                {
+                    IO_ASSERT(count < max_categories, "compact_error ERROR: too many error categories.");
+                    category_count.store(count + 1, std::memory_order_release);
+                }
+                categories[vacant].store(&cat, std::memory_order_release);
+                return vacant;
+            }
+        };
+
         struct dynamic_errc : public std::error_category {
             constexpr static int err_invalid = 0;
 
+            inline ~dynamic_errc() { compact_error::forget(*this); }
+
             const char *name() const noexcept override { return "io::promise has been rejected"; }
             std::string message(int ev) const override {
                 if (ev > 0 && ev < msg_pool.size()) {
@@ -437,6 +563,151 @@ namespace io
             std::vector<size_t> msg_released;
         };
 
+#if IO_USE_STACKFUL
+        namespace stackful {
+            // Per manager cache of stackful coroutine blocks (the mco_coro header and its stack),
+            // bucketed by power of two size classes. Cached blocks are reused without zeroing.
+            // Not thread safe: a manager only creates and destroys its own stackful coroutines.
+            struct stack_pool {
+                struct options {
+                    size_t max_cached_bytes = 64 * 1024 * 1024;     // 0: every finished stack is freed
+                    // mmap'd blocks with a no-access page below them: an overflow faults once it ran
+                    // through the coroutine header at the bottom of the block, pages are committed lazily.
+                    bool guard_pages = false;
+                };
+
+                stack_pool() = default;
+                stack_pool(const stack_pool&) = delete;
+                stack_pool& operator=(const stack_pool&) = delete;
+                inline ~stack_pool() { trim(); }
+
+                inline void set_options(const options& o) {
+                    opt = o;
+                    while (bytes > opt.max_cached_bytes)
+                        release_largest();
+                }
+                inline const options& get_options() const { return opt; }
+                inline size_t cached() const { return count; }
+                inline size_t cached_bytes() const { return bytes; }
+                // blocks taken from the cache / allocated by the system.
+                inline size_t reused() const { return reuse_count; }
+                inline size_t allocated() const { return alloc_count; }
+
+                // free every cached block.
+                inline void trim() {
+                    while (count)
+                        release_largest();
+                }
+
+                // mco_desc allocator callbacks. allocator_data is the cache of the current mode, the
+                // coroutine keeps it, so its block goes back to the cache it came from.
+                inline void* allocator_data() { return &caches[opt.guard_pages]; }
+                inline static void* alloc(size_t size, void* allocator_data) {
+                    cache& c = *static_cast<cache*>(allocator_data);
+                    stack_pool& pool = *c.owner;
+                    size_t index = class_of(size);
+                    if (c.buckets[index].size()) {
+                        void* block = c.buckets[index].back();
+                        c.buckets[index].pop_back();
+                        pool.count--;
+                        pool.bytes -= size_of(index);
+                        pool.reuse_count++;
+                        return block;
+                    }
+                    pool.alloc_count++;
+                    return system_alloc(size_of(index), c.guard);
+                }
+                inline static void dealloc(void* ptr, size_t size, void* allocator_data) {
+                    cache& c = *static_cast<cache*>(allocator_data);
+                    stack_pool& pool = *c.owner;
+                    size_t index = class_of(size);
+                    if (pool.bytes + size_of(index) > pool.opt.max_cached_bytes) {
+                        system_free(ptr, size_of(index), c.guard);
+                        return;
+                    }
+                    c.buckets[index].push_back(ptr);
+                    pool.count++;
+                    pool.bytes += size_of(index);
+                }
+
+            private:
+                static constexpr size_t classes = sizeof(size_t) * 8;
+                inline static size_t class_of(size_t size) { return std::bit_width(size - 1); }
+                inline static size_t size_of(size_t index) { return size_t(1) << index; }
+
+                inline static size_t page_size() {
+#if defined(_WIN32)
+                    static const size_t page = [] {
+                        SYSTEM_INFO info;
+                        GetSystemInfo(&info);
+                        return (size_t)info.dwPageSize;
+                        }();
+#else
+                    static const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+#endif
+                    return page;
+                }
+                inline static void* system_alloc(size_t size, bool guard) {
+                    if (!guard)
+                        return std::malloc(size);
+                    size_t page = page_size();
+#if defined(_WIN32)
+                    char* base = (char*)VirtualAlloc(NULL, size + page, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+                    if (base == nullptr)
+                        return nullptr;
+                    DWORD old;
+                    VirtualProtect(base, page, PAGE_NOACCESS, &old);
+#else
+                    void* mapped = mmap(nullptr, size + page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                    if (mapped == MAP_FAILED)
+                        return nullptr;
+                    char* base = (char*)mapped;
+                    mprotect(base, page, PROT_NONE);
+#endif
+                    return base + page;
+                }
+                inline static void system_free(void* block, size_t size, bool guard) {
+                    if (!guard) {
+                        std::free(block);
+                        return;
+                    }
+                    size_t page = page_size();
+#if defined(_WIN32)
+                    VirtualFree((char*)block - page, 0, MEM_RELEASE);
+#else
+                    munmap((char*)block - page, size + page);
+#endif
+                }
+                inline void release_largest() {
+                    for (size_t i = classes; i-- > 0;) {
+                        for (cache& c : caches) {
+                            if (c.buckets[i].size()) {
+                                system_free(c.buckets[i].back(), size_of(i), c.guard);
+                                c.buckets[i].pop_back();
+                                count--;
+                                bytes -= size_of(i);
+                                return;
+                            }
+                        }
+                    }
+                }
+
+                struct cache {
+                    stack_pool* owner;
+                    bool guard;
+                    std::array<std::vector<void*>, classes> buckets;
+                };
+                options opt;
+                // [0] malloc'd blocks, [1] blocks with guard pages
+                std::array<cache, 2> caches{ cache{ this, false, {} }, cache{ this, true, {} } };
+                size_t count = 0;
+                size_t bytes = 0;
+                size_t reuse_count = 0;
+                size_t alloc_count = 0;
+            };
+        }
+#endif
+
         // -------------------------------coroutine core--------------------------------
 
 #include "internal/lowlevel.h"
@@ -681,7 +952,7 @@ namespace io
             }
         private:
             inline promise(lowlevel::awaiter* a, T* p) noexcept :lowlevel::promise_base(a), ptr(p) {}
-            T* ptr;
+            T* ptr = nullptr;
         };
 
         template <>
@@ -708,11 +979,59 @@ namespace io
             void decons() noexcept;
         };
 
+        //periodic clock, made by make_periodic.
+        // The manager moves its node in the time chain to the next deadline on every tick, nothing is reallocated.
+        // co_await returns once per tick, and right away if a tick is pending.
+        // A tick firing while the previous one is still pending is dropped and counted as missed.
+        struct periodic: public future{
+            __IO_INTERNAL_HEADER_PERMISSION
+            // a tick is pending
+            inline bool isSet() { return awaiter && (awaiter->bit_set & awaiter->set_lock); }
+            inline bool armed() { return awaiter && (awaiter->bit_set & awaiter->is_periodic); }
+            // ticks dropped since make_periodic, saturates at UINT32_MAX
+            inline uint64_t missed() { return armed() ? awaiter->missed : 0; }
+            inline std::chrono::steady_clock::duration period() { return armed() ? awaiter->tm_periodic.period : std::chrono::steady_clock::duration{}; }
+            // deadline of the next tick
+            inline std::chrono::steady_clock::time_point next() { return armed() ? awaiter->tm->first : std::chrono::steady_clock::time_point{}; }
+            // disarm, the periodic becomes empty.
+            inline void stop() noexcept {
+                decons();
+                invalidate();
+            }
+            inline ~periodic() noexcept {
+                decons();
+            }
+            inline periodic& operator=(periodic&& right) noexcept {
+                decons();
+                static_cast<future*>(this)->operator=(static_cast<future&&>(right));
+                return *this;
+            }
+            periodic(periodic&&) = default;
+            inline periodic() {}
+        private:
+            promise<void> getPromise() = delete;
+            std::error_code getErr() = delete;
+            void decons() noexcept;
+        };
+
         //awaitable future receiver type
         // Not Thread safe.
         // UB: submit async_promise to another thread, and getErr before co_await.
         struct async_future : future {};
 
+        //awaitable future receiver type with data, returned by post for a callable with a result.
+        // Not Thread safe. Not movable, like future_with: declare it with auto, or co_await it right away.
+        // The result is moved into data on the manager of this future, then the future is resolved.
+        // If this future is gone by then, the result is dropped.
+        template <typename T>
+        struct async_future_with : future_with<T> {
+            __IO_INTERNAL_HEADER_PERMISSION
+        private:
+            // constructed in place by manager::post, which fills it before returning.
+            template <typename Fill>
+            inline explicit async_future_with(Fill&& fill) { fill(*this); }
+        };
+
         //awaitable promise sender type
         // Thread safe.
         struct async_promise {
@@ -748,6 +1067,27 @@ namespace io
         struct yield_t {};
         inline static constexpr yield_t yield;
 
+        template <size_t N>
+        struct migrate_t {
+            manager* target;
+            std::array<future*, N> futures;
+        };
+        // co_await io::migrate_to(target, futures...): moves this coroutine to the target manager, it resumes on the target's thread.
+        // Returns true once the coroutine runs on the target, false if it was refused and the coroutine stays where it is.
+        // A null target, or the coroutine's own manager, is a no-op that returns true.
+        // Every future the coroutine still holds is passed: an empty or settled one is moved along, it's re-settled on the target
+        //  with its outcome and data. A pending one, or an armed periodic, refuses the migration: its promise would settle it here.
+        // Only a detached coroutine moves (async_spawn, or its fsm_handle detached): a handle on this manager could destroy it.
+        // Futures not passed, handles of coroutines it spawned with spawn_now, and sockets of this manager's io_context must not be held.
+        //  A future left out keeps an awaiter of this manager: the target thread would later free it into this manager's hive,
+        //  racing with this thread.
+        // The target must outlive the move.
+        template <typename ...Futs>
+            requires (std::is_convertible_v<Futs&, future&> && ...)
+        inline migrate_t<sizeof...(Futs)> migrate_to(manager* target, Futs&... futs) {
+            return { target, { static_cast<future*>(&futs)... } };
+        }
+
         template <typename T>
             requires std::invocable<T>
         struct defer_t {
@@ -778,15 +1118,21 @@ namespace io
                 inline lowlevel::awaitable_base<T, false, lowlevel::selector_status::all, future> await_transform(yield_t) {
                     future fut;
                     _fsm.make_future(fut);
-                    fut.awaiter->no_tm.queue_next = _fsm.mngr->resolve_queue_local;
-                    _fsm.mngr->resolve_queue_local = fut.awaiter;
+                    fut.awaiter->queue_local();
                     fut.awaiter->coro = (std::function<void(lowlevel::awaiter*)>*)1;
                     return lowlevel::awaitable_base<T, false, lowlevel::selector_status::all, future>(*this, { fut.awaiter });
                 }
+                template <size_t N>
+                inline lowlevel::migrate_awaitable<T, N> await_transform(migrate_t<N>&& x) {
+                    return lowlevel::migrate_awaitable<T, N>(*this, x.target, x.futures);
+                }
                 inline lowlevel::awa_awaitable await_transform(awaitable& x) {
                     IO_ASSERT(x.operator bool() == false, "repeatly co_await in same object!");
                     return { &x.coro, &_fsm.is_awaiting };
                 }
+                inline lowlevel::wake_awaitable<T> await_transform(lowlevel::wake_signal& x) {
+                    return lowlevel::wake_awaitable<T>(*this, x);
+                }
                 template <typename T_Fut>
                     requires std::is_convertible_v<T_Fut&, io::future&>
                 inline lowlevel::awaitable_base<T, false, lowlevel::selector_status::all, T_Fut> await_transform(T_Fut& x) {
@@ -978,11 +1324,57 @@ namespace io
             allSettle = 3     // I suggest never use it, instead, loop and co_await one by one.
         };
 
+        // Source of manager::now(), which make_clock, make_periodic and io::timer count from.
+        enum class tick_mode {
+            precise = 0,    // steady_clock::now() on every call
+            cached = 1,     // steady_clock::now() once per drive() turn. Timers armed during a turn count from its start.
+            coarse = 2      // cached, read from CLOCK_MONOTONIC_COARSE on Linux: cheaper, timers fire up to its resolution late.
+        };
+
+        // How a resolved future resumes the coroutine awaiting it.
+        enum class resume_mode {
+            nested = 0,         // resumed right away inside resolve(), on the resolver's stack
+            trampolined = 1     // resolve() queues it, the outermost resolve() on the stack resumes the queue in order
+        };
+
+        // Spinning before drive() suspends, see manager::set_busy_poll.
+        struct busy_poll_options {
+            std::chrono::nanoseconds max_spin{0};     // longest spin per suspend, 0 turns busy polling off
+            bool adaptive = true;                     // tune the spin between 0 and max_spin, otherwise always spin max_spin
+            std::chrono::nanoseconds start_spin = std::chrono::microseconds(2);     // the spin an adaptive budget grows from
+        };
+        struct busy_poll_stats {
+            std::chrono::nanoseconds spinning{0};     // time spent spinning
+            std::chrono::nanoseconds sleeping{0};     // time spent blocked after the spin gave up
+            size_t spin_wakes = 0;                    // suspends that ended while spinning
+            size_t sleeps = 0;                        // suspends that fell back to blocking
+            std::chrono::nanoseconds spin_budget{0};  // current spin per suspend
+        };
+
         //scheduler, executor
         // 1 manager == 1 thread
         struct manager {
             __IO_INTERNAL_HEADER_PERMISSION;
-            inline manager() {}
+            inline manager() {
+                ready_awaiter.bit_set = ready_awaiter.initilaze | ready_awaiter.occupy_lock | ready_awaiter.set_lock | ready_awaiter.is_ready;
+                ready_awaiter.mngr = this;
+            }
+            // Tasks posted here that never ran are destroyed. Task nodes of this manager must not be in flight elsewhere.
+            inline ~manager() {
+                run_tasks(false);
+                lowlevel::task* node = free_tasks;
+                free_tasks = nullptr;
+                for (int i = 0; i < 2; i++)
+                {
+                    while (node != nullptr)
+                    {
+                        lowlevel::task* next = node->next;
+                        delete node;
+                        node = next;
+                    }
+                    node = returned_tasks.exchange(nullptr, std::memory_order_acquire);
+                }
+            }
             inline std::chrono::nanoseconds drive(
                 bool suspends = true, 
                 std::chrono::nanoseconds suspend_max = std::chrono::nanoseconds(400000000)
@@ -990,6 +1382,7 @@ namespace io
             {
                 manager *before_mngr = io::lowlevel::this_thread;
                 io::lowlevel::this_thread = this;
+                refresh_tick();
 
                 //pending task
                 std::queue<std::coroutine_handle<>> pendingTaskReady;
@@ -1008,6 +1401,9 @@ namespace io
                     break;
                 }
 
+                //posted tasks
+                run_tasks(true);
+
                 //async queueing awaiter to resolve
                 while (resolve_queue.lock.test_and_set(std::memory_order_acquire));
                 lowlevel::awaiter* readys = resolve_queue.queue;
@@ -1061,9 +1457,10 @@ namespace io
                     break;
                 }
 
-                //local queueing awaiter to resolve
+                //local queueing awaiter to resolve, in order
                 readys = resolve_queue_local;
                 resolve_queue_local = nullptr;
+                resolve_queue_local_tail = nullptr;
                 while (1)
                 {
                     if (readys != nullptr)
@@ -1079,16 +1476,21 @@ namespace io
 
                 //clocks
                 std::chrono::steady_clock::time_point suspend_next;
-                auto suspend_max_p = suspend_max + std::chrono::steady_clock::now();
+                auto suspend_max_p = suspend_max + this->now();
                 while (1)
                 {
                     if (auto iter = time_chain.begin(); iter != time_chain.end())
                     {
-                        const auto& now = std::chrono::steady_clock::now();
+                        const auto now = this->now();
                         const auto& [tm, a] = *iter;
                         if (tm <= now)
                         {
                             lowlevel::awaiter* awa = const_cast<lowlevel::awaiter*>(a);
+                            if (awa->bit_set & awa->is_periodic)
+                            {
+                                tick_periodic(iter, now);
+                                continue;
+                            }
                             promise<void> prom(awa);
                             time_chain.erase(iter);
                             prom.resolve();
@@ -1096,7 +1498,8 @@ namespace io
                         }
                         else
                         {
-                            suspend_next = tm;
+                            // a coarse tick lags the steady clock the suspend waits on by up to its resolution
+                            suspend_next = tm + coarse_resolution;
                             if (suspend_next >= suspend_max_p)
                             {
                                 suspend_next = suspend_max_p;
@@ -1118,25 +1521,22 @@ namespace io
                     i.destroy();
                 }
 
-                //deconstructed stackful
-#if IO_USE_STACKFUL
-                while (stackful_deconstruct.size())
-                {
-                    auto i = stackful_deconstruct.front();
-                    stackful_deconstruct.pop();
-                    mco_destroy(i);
-                }
-#endif
-
-                //suspend
-                if (is_suspend.test() == false && suspends)
+                //suspend. Handlers of io_ctx run in here at any time, they read the clock.
+                tick_is_cached = false;
+                // resolve_later on this thread after the local queue ran: don't sleep on it.
+                if (is_suspend.test() == false && suspends && resolve_queue_local == nullptr)
                 {
-#if IO_USE_ASIO
-                    io_ctx.run_until(suspend_next);
-                    io_ctx.restart();
-#else
-                    bool _nodiscard = suspend_sem.try_acquire_until(suspend_next);
-#endif
+                    // the clock is read around the suspend only once idle_time was asked for
+                    bool idle_tracked = idle_tracking.load(std::memory_order_relaxed);
+                    std::chrono::steady_clock::time_point idle_from;
+                    if (idle_tracked)
+                        idle_from = read_tick();
+                    if (busy_poll.max_spin.count() == 0)
+                        suspend_until(suspend_next);
+                    else
+                        busy_poll_suspend(suspend_next);
+                    if (idle_tracked)
+                        add_counter(idle_counter, (read_tick() - idle_from).count());
                 } else {
 
 #if IO_USE_ASIO
@@ -1149,8 +1549,8 @@ namespace io
                 
                 io::lowlevel::this_thread = before_mngr;
                 
-                if (is_suspend.test() == false && suspends == false)
-                    return std::chrono::duration_cast<std::chrono::nanoseconds>(suspend_next - std::chrono::steady_clock::now());
+                if (is_suspend.test() == false && suspends == false && resolve_queue_local == nullptr)
+                    return std::chrono::duration_cast<std::chrono::nanoseconds>(suspend_next - this->now());
                 else
                     return std::chrono::nanoseconds{0};
             }
@@ -1247,6 +1647,64 @@ namespace io
             void wakeup() {
                 suspend_release();
             }
+            // choose precision versus cost of the time timers count from, see tick_mode.
+            inline void set_tick_mode(tick_mode mode) {
+                _tick_mode = mode;
+                tick_is_cached = false;
+                coarse_resolution = {};
+#if defined(__linux__)
+                timespec res;
+                if (mode == tick_mode::coarse && clock_getres(CLOCK_MONOTONIC_COARSE, &res) == 0)
+                    coarse_resolution = std::chrono::seconds(res.tv_sec) + std::chrono::nanoseconds(res.tv_nsec);
+#endif
+            }
+            inline tick_mode get_tick_mode() const { return _tick_mode; }
+            /**
+             * Spin before suspending: drive() polls the wake flag of the resolve queues (and io_context) for up to
+             * the spin budget before it blocks, so a cross thread resolve is picked up without a futex/eventfd round trip.
+             * Adaptive budgets grow when the manager is woken shortly after it gave up spinning, and shrink when it sleeps long.
+             * Costs a busy core while spinning. Call it on the thread driving the manager.
+             */
+            inline void set_busy_poll(const busy_poll_options& options) {
+                busy_poll = options;
+                spin_budget = options.max_spin;
+                poll_counters.spin_budget.store(spin_budget.count(), std::memory_order_relaxed);
+            }
+            inline const busy_poll_options& get_busy_poll() const { return busy_poll; }
+            /**
+             * In resume_mode::trampolined, chains of coroutines resolving each other (pipelines, chan handoff)
+             * don't nest their resumes: the stack stays flat however long the chain is,
+             * and a suspending coroutine transfers straight to the next queued one.
+             * The resolver runs on until its resolve() returns or it suspends, before the awaiting coroutine resumes.
+             */
+            inline void set_resume_mode(resume_mode mode) {
+                IO_ASSERT(trampolining == false, "set_resume_mode ERROR: called while resuming the ready queue.");
+                _resume_mode = mode;
+            }
+            inline resume_mode get_resume_mode() const { return _resume_mode; }
+            // may be read from any thread
+            inline busy_poll_stats get_busy_poll_stats() const {
+                busy_poll_stats st;
+                st.spinning = std::chrono::nanoseconds(poll_counters.spinning.load(std::memory_order_relaxed));
+                st.sleeping = std::chrono::nanoseconds(poll_counters.sleeping.load(std::memory_order_relaxed));
+                st.spin_wakes = poll_counters.spin_wakes.load(std::memory_order_relaxed);
+                st.sleeps = poll_counters.sleeps.load(std::memory_order_relaxed);
+                st.spin_budget = std::chrono::nanoseconds(poll_counters.spin_budget.load(std::memory_order_relaxed));
+                return st;
+            }
+            // time drive() spent suspended, spinning included: the rest of the time the thread was busy, see pool::balance_target.
+            // Counted from the first call on, at the resolution of tick_mode. Any thread may read it.
+            inline std::chrono::nanoseconds idle_time() const {
+                if (idle_tracking.load(std::memory_order_relaxed) == false)
+                    idle_tracking.store(true, std::memory_order_relaxed);
+                return std::chrono::nanoseconds(idle_counter.load(std::memory_order_relaxed));
+            }
+            // current time, as read by tick_mode
+            inline std::chrono::steady_clock::time_point now() {
+                if (tick_is_cached)
+                    return tick;
+                return read_tick();
+            }
             template <typename T_Prom>
             inline promise<T_Prom> make_future(future& fut, T_Prom* mem_bind)
             {
@@ -1270,11 +1728,42 @@ namespace io
                 new (&fut.awaiter->tm) std::multimap<std::chrono::steady_clock::time_point, lowlevel::awaiter*>::iterator();
                 fut.awaiter->tm = this->time_chain.insert(
                     std::make_pair(
-                        static_cast<std::chrono::steady_clock::time_point>(std::chrono::steady_clock::now() + duration),
+                        static_cast<std::chrono::steady_clock::time_point>(this->now() + duration),
+                        static_cast<lowlevel::awaiter*>(fut.awaiter)
+                    )
+                );
+            }
+            // make a periodic clock, first tick one period from now.
+            template <typename T_Duration>
+            inline void make_periodic(periodic& fut, T_Duration period, periodic_mode mode = periodic_mode::fixed_rate)
+            {
+                auto p = std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+                IO_ASSERT(p.count() > 0, "make_periodic: the period must be positive!");
+                fut.decons();
+                FutureVaild(fut);
+                fut.awaiter->bit_set |= fut.awaiter->is_clock | fut.awaiter->clock_resolve | fut.awaiter->is_periodic;
+                if (mode == periodic_mode::fixed_delay)
+                    fut.awaiter->bit_set |= fut.awaiter->fixed_delay;
+                fut.awaiter->tm_periodic.period = p;
+                fut.awaiter->missed = 0;
+                new (&fut.awaiter->tm) std::multimap<std::chrono::steady_clock::time_point, lowlevel::awaiter*>::iterator();
+                fut.awaiter->tm = this->time_chain.insert(
+                    std::make_pair(
+                        static_cast<std::chrono::steady_clock::time_point>(this->now() + p),
                         static_cast<lowlevel::awaiter*>(fut.awaiter)
                     )
                 );
             }
+            /**
+             * A future that is already resolved. It points to an awaiter the manager keeps for all ready futures,
+             * so nothing is allocated and co_await returns at once. For the fast paths of protocols:
+             * a future_with<T> carries its data in itself, set it before or after.
+             */
+            inline void make_ready_future(future& fut)
+            {
+                fut.decons();
+                fut.awaiter = &ready_awaiter;
+            }
             inline void make_outdated_clock(clock& fut, bool isResolve = false)
             {
                 fut.decons();
@@ -1288,68 +1777,234 @@ namespace io
             // make async future pair
             inline async_promise make_future(async_future& fut)
             {
-                do {
-                    if (fut.awaiter != nullptr)
-                    {
-                        if (fut.awaiter->bit_set & fut.awaiter->promise_handled &&
-                            fut.awaiter->coro == nullptr)
-                        {
-                            fut.awaiter->reset();
-                            break;            //reuse of future obj
-                        }
-                        else
-                        {
-                            fut.awaiter->bit_set &= ~fut.awaiter->future_handled;
-                        }
+                return make_async(fut);
+            }
+            // Run func(args...) on the executor's thread, the future settles on this manager.
+            // The call is a task node from this manager, queued to the executor without a lock, and not a coroutine:
+            // once the nodes are warm, post allocates nothing but what a callable too large for the node needs.
+            // A callable with a result returns async_future_with: the executor puts the result in the same node and posts it back,
+            // and it is moved into the future's data here. A null executor rejects the future with not_connected.
+            template <typename Func, typename ...Args>
+            inline auto post(manager* executor, Func func, Args&&... args) {
+                using result_type = std::remove_cvref_t<std::invoke_result_t<Func&, std::decay_t<Args>&...>>;
+                if constexpr (std::is_void_v<result_type>) {
+                    async_future fut;
+                    async_promise prom = make_future(fut);
+                    if (executor == nullptr) {
+                        prom.reject(std::make_error_code(std::errc::not_connected));
+                        return fut;
                     }
-                    auto new_awaiter = this->awaiter_hive.emplace();
-                    fut.awaiter = new_awaiter;
-                    fut.awaiter->mngr = this;
-                    break;
-                } while (0);
+
+                    executor->push_task(make_task(
+                        [prom = std::move(prom), func = std::move(func),
+                         args_tuple = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+#if IO_EXCEPTION_ON
+                            try {
+#endif
+                                std::apply(func, args_tuple);
+                                prom.resolve();
+#if IO_EXCEPTION_ON
+                            }
+                            catch (...) {
+                                prom.reject(std::make_error_code(std::errc::invalid_argument));
+                            }
+#endif
+                        }));
+
+                    return fut;
+                }
+                else {
+                    return async_future_with<result_type>([&](async_future_with<result_type>& fut) {
+                        async_promise prom = make_async(fut);
+                        if (executor == nullptr) {
+                            prom.reject(std::make_error_code(std::errc::not_connected));
+                            return;
+                        }
+
+                        executor->push_task(make_result_task(&fut.data, std::move(prom),
+                            [func = std::move(func), args_tuple = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+                                return std::apply(func, args_tuple);
+                            }));
+                    });
+                }
+            }
+            template <typename Func, typename ...Args>
+            auto post(pool& thread_pool, Func func, Args&&... args);
+            manager(const manager&) = delete;
+            manager& operator=(const manager&) = delete;
+            manager(manager&& right) = delete;
+            manager& operator=(manager&& right) = delete;
+        private:
+            inline async_promise make_async(future& fut)
+            {
+                FutureVaild(fut);
                 async_promise ret;
                 ret.awaiter = fut.awaiter;
                 return ret;
             }
-            template <typename Func, typename ...Args>
-            inline async_future post(manager* executor, Func func, Args&&... args) {
-                async_future fut;
-                async_promise prom = make_future(fut);
-                
-                auto func_with_args = [func = std::move(func), 
-                                       args_tuple = std::make_tuple(std::forward<Args>(args)...)]() {
-                    return std::apply(func, args_tuple);
+            template <typename T>
+            static constexpr bool task_inline = sizeof(T) <= lowlevel::task::inline_size && alignof(T) <= alignof(std::max_align_t);
+            template <typename T, typename F>
+            static inline void store_task(lowlevel::task* node, F&& f) {
+                if constexpr (task_inline<T>)
+                    new (node->storage) T(std::forward<F>(f));
+                else
+                    *reinterpret_cast<T**>(node->storage) = new T(std::forward<F>(f));
+            }
+            template <typename T>
+            static inline T* stored_task(lowlevel::task* node) {
+                if constexpr (task_inline<T>)
+                    return std::launder(reinterpret_cast<T*>(node->storage));
+                else
+                    return *reinterpret_cast<T**>(node->storage);
+            }
+            template <typename T>
+            static inline void destroy_task(lowlevel::task* node) {
+                if constexpr (task_inline<T>)
+                    stored_task<T>(node)->~T();
+                else
+                    delete stored_task<T>(node);
+            }
+            // fills a node with a plain callable
+            template <typename F>
+            static inline void fill_task(lowlevel::task* node, F&& f) {
+                using T = std::decay_t<F>;
+                store_task<T>(node, std::forward<F>(f));
+                node->invoke = [](lowlevel::task* self, bool run) {
+                    if (run)
+                        (*stored_task<T>(self))();
+                    destroy_task<T>(self);
+                    return false;
                 };
-                
-                executor->async_spawn(
-                    [](async_promise prom, decltype(func_with_args) func)
-                    -> fsm_func<void> {
+            }
+            inline lowlevel::task* take_task() {
+                lowlevel::task* node = free_tasks;
+                if (node == nullptr) [[unlikely]]
+                    node = returned_tasks.exchange(nullptr, std::memory_order_acquire);
+                if (node == nullptr) [[unlikely]]
+                {
+                    node = new lowlevel::task;
+                    node->owner = this;
+                    node->next = nullptr;
+                }
+                free_tasks = node->next;
+                return node;
+            }
+            // a task node of this manager, holding the callable
+            template <typename F>
+            inline lowlevel::task* make_task(F&& f) {
+                lowlevel::task* node = take_task();
+                fill_task(node, std::forward<F>(f));
+                return node;
+            }
+            // the value returning side of post. The executor runs the call, then refills the same node with the result
+            // and posts it back to the carrier, which settles the future there. So the node is always given back by its owner.
+            template <typename R, typename Call>
+            struct result_call {
+                manager* carrier;
+                R* dest;
+                async_promise prom;
+                Call call;
+            };
+            template <typename R>
+            struct result_back {
+                R* dest;
+                R result;
+                async_promise prom;
+            };
+            // any thread: refills an empty node of the carrier with the result, and posts it back to the carrier.
+            // There the result is moved into the future's data, and the node is free again before the future's coroutine resumes.
+            template <typename R>
+            static inline void send_result(manager* carrier, lowlevel::task* node, R* dest, R&& result, async_promise&& prom) {
+                store_task<result_back<R>>(node, result_back<R>{ dest, std::move(result), std::move(prom) });
+                node->invoke = [](lowlevel::task* self, bool run) {
+                    result_back<R>* back = stored_task<result_back<R>>(self);
+                    promise<R> settle(back->prom.awaiter.exchange(nullptr), back->dest);
+                    R* data = run ? settle.data() : nullptr;
+                    if (data)
+                        *data = std::move(back->result);
+                    destroy_task<result_back<R>>(self);
+                    self->next = self->owner->free_tasks;
+                    self->owner->free_tasks = self;
+                    if (data)
+                        settle.resolve();
+                    return true;
+                };
+                carrier->push_task(node);
+            }
+            template <typename R, typename Call>
+            inline lowlevel::task* make_result_task(R* dest, async_promise&& prom, Call&& call) {
+                using T = result_call<R, std::decay_t<Call>>;
+                lowlevel::task* node = take_task();
+                store_task<T>(node, T{ this, dest, std::move(prom), std::forward<Call>(call) });
+                node->invoke = [](lowlevel::task* self, bool run) {
+                    T* state = stored_task<T>(self);
+                    if (run)
+                    {
 #if IO_EXCEPTION_ON
                         try {
 #endif
-                            func();
-                            prom.resolve();
+                            R result = state->call();
+                            manager* carrier = state->carrier;
+                            R* dest = state->dest;
+                            async_promise prom = std::move(state->prom);
+                            destroy_task<T>(self);
+                            send_result(carrier, self, dest, std::move(result), std::move(prom));
+                            return true;
 #if IO_EXCEPTION_ON
                         }
                         catch (...) {
-                            prom.reject(std::make_error_code(std::errc::invalid_argument));
+                            state->prom.reject(std::make_error_code(std::errc::invalid_argument));
                         }
 #endif
-                        co_return;
-                    }(std::move(prom), std::move(func_with_args)));
-                
-                return fut;
+                    }
+                    destroy_task<T>(self);
+                    return false;
+                };
+                return node;
+            }
+            // any thread: a lock free stack, newest first.
+            inline void push_task(lowlevel::task* node) {
+                node->next = posted_tasks.load(std::memory_order_relaxed);
+                while (!posted_tasks.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed));
+                suspend_release();
+            }
+            // takes the posted tasks, runs them in the order they were posted, and gives their nodes back.
+            inline void run_tasks(bool run) {
+                lowlevel::task* node = posted_tasks.exchange(nullptr, std::memory_order_acquire);
+                lowlevel::task* ordered = nullptr;
+                while (node != nullptr)
+                {
+                    lowlevel::task* next = node->next;
+                    node->next = ordered;
+                    ordered = node;
+                    node = next;
+                }
+                while (ordered != nullptr)
+                {
+                    lowlevel::task* next = ordered->next;
+                    if (ordered->invoke(ordered, run))
+                    {
+                        ordered = next;     // posted on or given back by the task itself
+                        continue;
+                    }
+                    manager* owner = ordered->owner;
+                    if (owner == this)
+                    {
+                        ordered->next = free_tasks;
+                        free_tasks = ordered;
+                    }
+                    else
+                    {
+                        ordered->next = owner->returned_tasks.load(std::memory_order_relaxed);
+                        while (!owner->returned_tasks.compare_exchange_weak(ordered->next, ordered, std::memory_order_release, std::memory_order_relaxed));
+                    }
+                    ordered = next;
+                }
             }
-            template <typename Func, typename ...Args>
-            async_future post(pool& thread_pool, Func func, Args&&... args);
-            manager(const manager&) = delete;
-            manager& operator=(const manager&) = delete;
-            manager(manager&& right) = delete;
-            manager& operator=(manager&& right) = delete;
-        private:
             inline bool FutureVaild(future& fut)
             {
-                if (fut.awaiter != nullptr)
+                if (fut.awaiter != nullptr && (fut.awaiter->bit_set & fut.awaiter->is_ready) == false)    // the ready awaiter is shared
                 {
                     if ((fut.awaiter->bit_set & fut.awaiter->promise_handled) == false &&
                         fut.awaiter->coro == nullptr)
@@ -1367,14 +2022,204 @@ namespace io
                 fut.awaiter->mngr = this;
                 return false;
             }
+            inline std::chrono::steady_clock::time_point read_tick() {
+#if defined(__linux__)
+                if (_tick_mode == tick_mode::coarse)
+                {
+                    // the same epoch as steady_clock (CLOCK_MONOTONIC)
+                    timespec ts;
+                    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+                    return std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec)));
+                }
+#endif
+                return std::chrono::steady_clock::now();
+            }
+            inline void refresh_tick() {
+                if (_tick_mode != tick_mode::precise)
+                {
+                    tick = read_tick();
+                    tick_is_cached = true;
+                }
+            }
+            // resumes a coroutine whose await is fulfilled, see resume_mode.
+            inline void resume_ready(std::coroutine_handle<> h, lowlevel::fsm_base& fsm) {
+                if (_resume_mode == resume_mode::nested) [[likely]]
+                    h.resume();
+                else
+                    trampoline(h, fsm);
+            }
+            inline void trampoline(std::coroutine_handle<> h, lowlevel::fsm_base& fsm) {
+                if (trampolining)
+                {
+                    fsm.is_awaiting = false;    // queued, it's on the call chain now: destroying it is delayed.
+                    ready_queue.push_back(h);
+                    return;
+                }
+                // reset even if an exception escapes a resume. What is still queued runs in the next trampoline.
+                struct reset_guard {
+                    bool& flag;
+                    inline ~reset_guard() { flag = false; }
+                } guard{ trampolining };
+                trampolining = true;
+                h.resume();
+                while (ready_head < ready_queue.size())
+                    ready_queue[ready_head++].resume();
+                ready_queue.clear();
+                ready_head = 0;
+            }
+            // symmetric transfer target for a suspending coroutine
+            inline std::coroutine_handle<> next_ready() {
+                if (trampolining == false)      // the queue is empty
+                    return std::noop_coroutine();
+#if IO_USE_STACKFUL
+                if (current_stackful != nullptr)    // don't run the queue on a small stackful stack
+                    return std::noop_coroutine();
+#endif
+                if (ready_head < ready_queue.size())
+                    return ready_queue[ready_head++];
+                return std::noop_coroutine();
+            }
+            // blocks until suspend_next, a wake up from another thread, or a handler of io_ctx queued work on this thread.
+            // Handlers use resolve_later without waking: the check after each one ends the suspend.
+            inline void suspend_until(std::chrono::steady_clock::time_point suspend_next) {
+#if IO_USE_ASIO
+                while (io_ctx.run_one_until(suspend_next) && resolve_queue_local == nullptr && is_suspend.test() == false);
+                io_ctx.restart();
+#else
+                bool _nodiscard = suspend_sem.try_acquire_until(suspend_next);
+#endif
+            }
+            // single writer, the counters are only atomic to be read from other threads
+            static inline void add_counter(std::atomic<int64_t>& counter, int64_t n) {
+                counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            }
+            // suspend phase of drive() with busy polling on
+            inline void busy_poll_suspend(std::chrono::steady_clock::time_point suspend_next) {
+                auto spin_begin = std::chrono::steady_clock::now();
+                auto spin_end = spin_begin + spin_budget;
+                if (spin_end > suspend_next)
+                    spin_end = suspend_next;
+                bool woken = false;
+                auto now = spin_begin;
+                for (size_t i = 1; ; i++)
+                {
+                    if (is_suspend.test(std::memory_order_acquire))
+                    {
+                        woken = true;
+                        break;
+                    }
+#if IO_USE_ASIO
+                    // handlers ran, they may have armed clocks or resumed coroutines: back to the caller for the next turn.
+                    if (io_ctx.poll())
+                    {
+                        woken = true;
+                        break;
+                    }
+#endif
+                    if (i % 16 == 0)
+                    {
+                        now = std::chrono::steady_clock::now();
+                        if (now >= spin_end)
+                            break;
+                        std::this_thread::yield();
+                    }
+                }
+                if (woken)
+                {
+                    now = std::chrono::steady_clock::now();
+#if IO_USE_ASIO
+                    io_ctx.restart();
+#else
+                    bool _nodiscard = suspend_sem.try_acquire();    // the wake up released it, drop the token
+#endif
+                    add_counter(poll_counters.spinning, (now - spin_begin).count());
+                    add_counter(poll_counters.spin_wakes, 1);
+                    return;
+                }
+                add_counter(poll_counters.spinning, (now - spin_begin).count());
+                if (now >= suspend_next)
+                    return;
+
+                suspend_until(suspend_next);
+                auto wake = std::chrono::steady_clock::now();
+                auto slept = wake - now;
+                add_counter(poll_counters.sleeping, slept.count());
+                add_counter(poll_counters.sleeps, 1);
+
+                if (busy_poll.adaptive)
+                {
+                    // woken soon after giving up: a longer spin would have caught it. Otherwise the spin was wasted.
+                    if (wake < suspend_next && spin_budget + slept <= busy_poll.max_spin)
+                        spin_budget = std::clamp<std::chrono::nanoseconds>(std::max(spin_budget * 2, busy_poll.start_spin),
+                            std::chrono::nanoseconds(0), busy_poll.max_spin);
+                    else if ((spin_budget /= 2) < busy_poll.start_spin)
+                        spin_budget = std::chrono::nanoseconds(0);
+                }
+                poll_counters.spin_budget.store(spin_budget.count(), std::memory_order_relaxed);
+            }
+            // moves the node of an expired periodic clock to its next deadline, then sets it.
+            inline void tick_periodic(std::multimap<std::chrono::steady_clock::time_point, lowlevel::awaiter*>::iterator iter, std::chrono::steady_clock::time_point now)
+            {
+                lowlevel::awaiter* awa = iter->second;
+                if ((awa->bit_set & awa->future_handled) == false && awa->coro == nullptr)
+                {
+                    // the periodic was destroyed while being awaited
+                    time_chain.erase(iter);
+                    awa->erase_this();
+                    return;
+                }
+                auto node = time_chain.extract(iter);
+                auto period = awa->tm_periodic.period;
+                if (awa->bit_set & awa->fixed_delay)
+                {
+                    node.key() = now + period;
+                }
+                else
+                {
+                    auto behind = (now - node.key()) / period;
+                    awa->missed = (uint32_t)std::min<uint64_t>(uint64_t(awa->missed) + uint64_t(behind), std::numeric_limits<uint32_t>::max());
+                    node.key() += (behind + 1) * period;
+                }
+                awa->tm = time_chain.insert(std::move(node));
+                if (awa->bit_set & awa->set_lock)
+                {
+                    if (awa->missed != std::numeric_limits<uint32_t>::max())
+                        awa->missed++;
+                }
+                else
+                    awa->set();     // may resume the coroutine, awa is not touched after.
+            }
             std::queue<std::coroutine_handle<>> pendingTask; //async queueing to pending task
             std::atomic_flag spinLock_pd = ATOMIC_FLAG_INIT;
 
+            std::atomic<lowlevel::task*> posted_tasks = nullptr;    // posted to this manager, see push_task
+            lowlevel::task* free_tasks = nullptr;                   // nodes of this manager for its next posts
+            std::atomic<lowlevel::task*> returned_tasks = nullptr;  // nodes of this manager given back after they ran elsewhere
+
             std::atomic_flag is_suspend = ATOMIC_FLAG_INIT;
 
             std::multimap<std::chrono::steady_clock::time_point, lowlevel::awaiter*> time_chain;
 
-            lowlevel::awaiter* resolve_queue_local = nullptr;   //local queueing to resolve
+            tick_mode _tick_mode = tick_mode::precise;
+            bool tick_is_cached = false;                    // tick is valid for now()
+            std::chrono::steady_clock::time_point tick;     // refreshed at the start of drive()
+            std::chrono::steady_clock::duration coarse_resolution{};
+
+            busy_poll_options busy_poll;
+            std::chrono::nanoseconds spin_budget{0};
+            struct {
+                std::atomic<int64_t> spinning = 0;
+                std::atomic<int64_t> sleeping = 0;
+                std::atomic<int64_t> spin_wakes = 0;
+                std::atomic<int64_t> sleeps = 0;
+                std::atomic<int64_t> spin_budget = 0;
+            } poll_counters;
+            std::atomic<int64_t> idle_counter = 0;          // see idle_time
+            mutable std::atomic<bool> idle_tracking = false;
+
+            lowlevel::awaiter* resolve_queue_local = nullptr;   //local queueing to resolve, FIFO
+            lowlevel::awaiter* resolve_queue_local_tail = nullptr;
 
             lowlevel::await_queue resolve_queue;      //async queueing to resolve
 
@@ -1389,7 +2234,8 @@ namespace io
 #if IO_USE_STACKFUL
             mco_coro *current_stackful = nullptr;
 
-            std::queue<mco_coro*> stackful_deconstruct;
+            // finished stackful coroutines are destroyed by their resumer, their blocks come back here.
+            stackful::stack_pool stackful_stacks;
 #endif
 
 #if IO_USE_ASIO
@@ -1411,27 +2257,165 @@ namespace io
             }
 
             io::hive<lowlevel::awaiter> awaiter_hive = io::hive<lowlevel::awaiter>(1000);
+            lowlevel::awaiter ready_awaiter;    // see make_ready_future
+
+            // read on every resume, next to the hive the resolver just used
+            resume_mode _resume_mode = resume_mode::nested;
+            bool trampolining = false;                              // a trampoline() is on the stack
+            std::vector<std::coroutine_handle<>> ready_queue;       // coroutines to resume, in order
+            size_t ready_head = 0;
+        };
+
+        // the NUMA nodes of the CPUs, read once.
+        // Linux: /sys/devices/system/node. Elsewhere, or without it, every CPU is on node 0.
+        struct cpu_topology {
+            std::vector<int> allowed;           // the CPUs this process may run on
+            std::vector<int> node_of_cpu;       // by CPU number
+            size_t nodes = 1;
+            inline int node_of(int cpu) const {
+                return cpu >= 0 && (size_t)cpu < node_of_cpu.size() ? node_of_cpu[cpu] : 0;
+            }
+            inline static const cpu_topology& get() {
+                static const cpu_topology topology = read();
+                return topology;
+            }
+            // "0-3,8,10-11"
+            inline static std::vector<int> parse_list(const char* list) {
+                std::vector<int> cpus;
+                while (*list) {
+                    char* end;
+                    long first = strtol(list, &end, 10);
+                    if (end == list)
+                        break;
+                    long last = first;
+                    if (*end == '-')
+                        last = strtol(end + 1, &end, 10);
+                    for (long cpu = first; cpu <= last; cpu++)
+                        cpus.push_back((int)cpu);
+                    list = *end == ',' ? end + 1 : end;
+                }
+                return cpus;
+            }
+        private:
+            inline static cpu_topology read() {
+                cpu_topology topology;
+#if defined(__linux__)
+                cpu_set_t set;
+                if (sched_getaffinity(0, sizeof(set), &set) == 0)
+                    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+                        if (CPU_ISSET(cpu, &set))
+                            topology.allowed.push_back(cpu);
+
+                char line[4096];
+                std::vector<int> online;
+                if (FILE* file = fopen("/sys/devices/system/node/online", "r")) {
+                    if (fgets(line, sizeof(line), file))
+                        online = parse_list(line);
+                    fclose(file);
+                }
+                for (int node : online) {
+                    std::string path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+                    FILE* file = fopen(path.c_str(), "r");
+                    if (file == nullptr)
+                        continue;
+                    if (fgets(line, sizeof(line), file)) {
+                        for (int cpu : parse_list(line)) {
+                            if ((size_t)cpu >= topology.node_of_cpu.size())
+                                topology.node_of_cpu.resize(cpu + 1, 0);
+                            topology.node_of_cpu[cpu] = node;
+                        }
+                    }
+                    fclose(file);
+                    topology.nodes = std::max<size_t>(topology.nodes, node + 1);
+                }
+#endif
+                if (topology.allowed.empty())
+                    for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); cpu++)
+                        topology.allowed.push_back((int)cpu);
+                return topology;
+            }
         };
 
         //thread pool. 
         // Launch when constructing.
         struct pool {
 			__IO_INTERNAL_HEADER_PERMISSION;
+            // where the threads run
+            enum class affinity {
+                none,   // wherever the OS puts them
+                cpu,    // one CPU each, taken in turn from the CPU set sorted by node, so neighbour threads share a node
+                node    // every CPU of the set on one NUMA node each, the threads dealt over the nodes of the set in turn
+            };
+            // when rebalance moves a coroutine, see balance_target
+            struct balance_options {
+                double saturated = 0.9;             // busy fraction of a thread its coroutines are moved away from
+                double margin = 0.2;                // at least this much less busy: the thread they are moved to
+                std::chrono::milliseconds window{100};     // the loads are sampled at most this often
+                double step = 0.01;                 // load a move is assumed to shift until the next sample, so moves don't herd
+            };
+            struct options {
+                size_t threads = 0;                 // 0: one per CPU of the set
+                pool::affinity affinity = pool::affinity::none;
+                std::vector<int> cpus;              // the CPU set, empty: every CPU this process may run on
+                busy_poll_options busy_poll;
+                balance_options balance;
+            };
+            // a thread to post to or spawn on, see on_node and on_cpu
+            struct hint {
+                int node = -1;
+                int cpu = -1;
+                bool keyed = false;
+                uint64_t key = 0;                   // hash of the key, see by_key
+            };
             struct _thread {
 				std::thread thread;
                 std::atomic_flag stopFlag = ATOMIC_FLAG_INIT;
-				manager mngr;
-                inline _thread() {
-                    thread = std::thread([this]() {
+                // made by the thread itself once it's pinned: the manager, and all it allocates later on the thread,
+                //  is first touched on the thread's node.
+				manager* mngr = nullptr;
+                std::vector<int> cpus;              // pinned to, empty: not pinned
+                int node = -1;                      // -1: not pinned to a node
+                std::atomic<int> load = 0;          // busy per mille over the last sample window, see balance_target
+                int64_t sampled_idle = 0;           // idle_time of the manager at the last sample
+                inline _thread(const busy_poll_options& options = {}, std::vector<int> cpus_ = {}, int node_ = -1)
+                    : cpus(std::move(cpus_)), node(node_) {
+                    std::binary_semaphore ready(0);
+                    thread = std::thread([this, &options, &ready]() {
+                        pin(cpus);
+                        mngr = new manager;
+                        mngr->set_busy_poll(options);
+                        ready.release();
                         while (!stopFlag.test(std::memory_order_acquire)) {
-                            mngr.drive();
+                            mngr->drive();
                         }
                     });
+                    ready.acquire();
+                }
+                inline ~_thread() {
+                    if (thread.joinable()) {
+                        stopFlag.test_and_set(std::memory_order_release);
+                        mngr->wakeup();
+                        thread.join();
+                    }
+                    delete mngr;
                 }
                 _thread(const _thread&) = delete;
                 _thread& operator=(const _thread&) = delete;
                 _thread(_thread&&) = delete;
                 _thread& operator=(_thread&&) = delete;
+            private:
+                inline static void pin(const std::vector<int>& cpus) {
+                    if (cpus.empty())
+                        return;
+#if defined(__linux__)
+                    cpu_set_t set;
+                    CPU_ZERO(&set);
+                    for (int cpu : cpus)
+                        if (cpu >= 0 && cpu < CPU_SETSIZE)
+                            CPU_SET(cpu, &set);
+                    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);     // CPUs not allowed: left unpinned
+#endif
+                }
             };
             std::deque<_thread> threadsInPool;
             // Thread distribution counter
@@ -1439,12 +2423,16 @@ namespace io
 
             pool(const pool&) = delete;
             pool& operator=(const pool&) = delete;
-            inline pool(pool&& other) noexcept : threadsInPool(std::move(other.threadsInPool)), next_thread(other.next_thread.load()) {}
+            inline pool(pool&& other) noexcept : threadsInPool(std::move(other.threadsInPool)), next_thread(other.next_thread.load()),
+                placement(other.placement), balancing(other.balancing) {}
             inline pool& operator=(pool&& other) noexcept {
                 if (this != &other) {
                     stop();
                     threadsInPool = std::move(other.threadsInPool);
 					next_thread = other.next_thread.load();
+                    placement = other.placement;
+                    balancing = other.balancing;
+                    sampled_at = 0;
                 }
                 return *this;
             }
@@ -1452,22 +2440,388 @@ namespace io
             /**
              * Posts a function to be executed on a thread in the pool
              * 
-             * @return async_future that can be used to await completion
+             * @return async_future that can be used to await completion,
+             *  or async_future_with<R> carrying the result if the function returns R.
+             *  Rejected with not_connected if the pool has no thread.
              */
             template <typename Func, typename ...Args>
-            inline async_future post(manager* future_carrier, Func func, Args&&... args) {
-                if (threadsInPool.empty()) {
-                    async_future fut;
-                    auto prom = future_carrier->make_future(fut);
-                    prom.reject(std::make_error_code(std::errc::not_connected));
-                    return fut;
-                }
+            inline auto post(manager* future_carrier, Func func, Args&&... args) {
+                manager* executor = nullptr;
+                if (!threadsInPool.empty())
+                    executor = threadsInPool[next_thread++ % threadsInPool.size()].mngr;
                 
                 return future_carrier->post(
-                    &(threadsInPool[next_thread++ % threadsInPool.size()].mngr),
+                    executor,
+                    std::move(func),
+                    std::forward<Args>(args)...);
+            }
+            /**
+             * Posts a function to a thread on the node, or pinned to the CPU, of the hint
+             *  Any thread if there is none, round robin among the ones there are.
+             *  A hint by_key posts to the thread owning the key, through the task queue of its manager:
+             *  a lock free queue any thread pushes to, run in order by that thread.
+             */
+            template <typename Func, typename ...Args>
+            inline auto post(hint where, manager* future_carrier, Func func, Args&&... args) {
+                return future_carrier->post(
+                    pick(where),
                     std::move(func),
                     std::forward<Args>(args)...);
             }
+            inline static hint on_node(int node) { return { node, -1 }; }
+            inline static hint on_cpu(int cpu) { return { -1, cpu }; }
+            // the thread owning the key: the same one for every post and spawn of the key, as long as the pool keeps its size.
+            // So the state of a key is only touched by one thread, without a lock. A key is an integer, a string,
+            //  or anything std::hash takes. The hash doesn't change between runs for integers and strings.
+            template <typename Key>
+            inline static hint by_key(const Key& key) { return { -1, -1, true, hash_key(key) }; }
+            template <typename Key>
+            inline static uint64_t hash_key(const Key& key) {
+                uint64_t h;
+                if constexpr (std::is_integral_v<Key> || std::is_enum_v<Key>)
+                    h = static_cast<uint64_t>(key);
+                else if constexpr (std::is_convertible_v<const Key&, std::string_view>) {
+                    h = 14695981039346656037ull;        // FNV-1a
+                    for (unsigned char c : std::string_view(key))
+                        h = (h ^ c) * 1099511628211ull;
+                }
+                else
+                    h = std::hash<Key>{}(key);
+                h ^= h >> 33;                           // mixed, so nearby integers spread over the threads
+                h *= 0xff51afd7ed558ccdull;
+                h ^= h >> 33;
+                h *= 0xc4ceb9fe1a85ec53ull;
+                return h ^ (h >> 33);
+            }
+            // jump consistent hash: the thread of a key hash among shards threads.
+            //  Going from n to n + 1 shards moves a key with a chance of 1 / (n + 1), and only to the new shard.
+            inline static size_t shard_of(uint64_t hash, size_t shards) {
+                int64_t b = -1, j = 0;
+                while (j < (int64_t)shards) {
+                    b = j;
+                    hash = hash * 2862933555777941757ull + 1;
+                    j = int64_t((b + 1) * (double(int64_t(1) << 31) / double((hash >> 33) + 1)));
+                }
+                return size_t(b < 0 ? 0 : b);
+            }
+            
+            /**
+             * Runs func over [first, last) on the threads of the pool, the returned future settles on future_carrier
+             * 
+             * first and last are integers or random access iterators. func is called with every index,
+             *  or every element for iterators, or with a whole chunk if it takes two: func(chunk_first, chunk_last).
+             *  It runs on several threads at once.
+             * The range is cut into chunks that the threads claim one after another, each a share of what is left:
+             *  large at first, smaller towards the end, never below grain (0: picked from the range size).
+             *  So a thread that is busy with something else claims less, and the others don't wait for it.
+             * Call it on the thread of future_carrier, like post. Nothing blocks there, co_await the future.
+             * 
+             * @return async_future resolved when every chunk is done.
+             *  Rejected with invalid_argument if func throws, with not_connected if the pool has no thread.
+             */
+            template <typename First, typename Last, typename Func>
+            inline async_future parallel_for(manager* future_carrier, First first_, Last last_, Func func, size_t grain = 0) {
+                using Index = std::common_type_t<First, Last>;
+                Index first = first_, last = last_;
+                async_future fut;
+                async_promise prom = future_carrier->make_future(fut);
+                size_t count = range_size(first, last);
+                if (threadsInPool.empty()) {
+                    prom.reject(std::make_error_code(std::errc::not_connected));
+                    return fut;
+                }
+                if (count == 0) {
+                    prom.resolve();
+                    return fut;
+                }
+
+                auto job = new for_job<Index, Func>(first, std::move(func));
+                job->prom = std::move(prom);
+                job->chunks.init(count, grain, threadsInPool.size());
+                start_parts(future_carrier, job, job->chunks.parts());
+                return fut;
+            }
+
+            /**
+             * reduce(init, transform(x)...) over [first, last) on the threads of the pool, the returned future settles on future_carrier
+             * 
+             * x is every index, or every element for iterators. Chunks are claimed like in parallel_for,
+             *  every thread reduces its own chunks, then the partial results are reduced into init:
+             *  the order is unspecified, reduce must be associative and commutative.
+             * 
+             * @return async_future_with<T>, its data is the result once awaited. Declare it with auto.
+             *  Rejected with invalid_argument if a function throws, with not_connected if the pool has no thread.
+             */
+            template <typename First, typename Last, typename T, typename Reduce, typename Transform>
+            inline auto transform_reduce(manager* future_carrier, First first_, Last last_, T init, Reduce reduce, Transform transform, size_t grain = 0) {
+                using Index = std::common_type_t<First, Last>;
+                Index first = first_, last = last_;
+                return async_future_with<T>([&](async_future_with<T>& fut) {
+                    async_promise prom = future_carrier->make_async(fut);
+                    size_t count = range_size(first, last);
+                    if (threadsInPool.empty()) {
+                        prom.reject(std::make_error_code(std::errc::not_connected));
+                        return;
+                    }
+                    if (count == 0) {
+                        fut.data = std::move(init);
+                        prom.resolve();
+                        return;
+                    }
+
+                    auto job = new reduce_job<Index, T, Reduce, Transform>(first, std::move(init), std::move(reduce), std::move(transform));
+                    job->prom = std::move(prom);
+                    job->carrier = future_carrier;
+                    job->dest = &fut.data;
+                    job->back = future_carrier->take_task();
+                    job->chunks.init(count, grain, threadsInPool.size());
+                    start_parts(future_carrier, job, job->chunks.parts());
+                });
+            }
+
+            /**
+             * Sorts [first, last) on the threads of the pool, the returned future settles on future_carrier
+             * 
+             * The range is cut into a few runs per thread, at least grain elements each (0: 4096).
+             *  The threads claim runs and sort them. Whoever sorts the second of two neighbour runs merges them,
+             *  and climbs on while the neighbour of the merged run is done too, so no thread waits for another.
+             *  The last merges are done by one thread each.
+             * Not stable. Don't touch the range until the future is settled.
+             * 
+             * @return async_future resolved when the range is sorted.
+             *  Rejected with invalid_argument if comp throws, with not_connected if the pool has no thread.
+             */
+            template <typename Iter, typename Compare = std::less<>>
+            inline async_future sort(manager* future_carrier, Iter first, Iter last, Compare comp = {}, size_t grain = 0) {
+                async_future fut;
+                async_promise prom = future_carrier->make_future(fut);
+                size_t count = range_size(first, last);
+                if (threadsInPool.empty()) {
+                    prom.reject(std::make_error_code(std::errc::not_connected));
+                    return fut;
+                }
+                if (count < 2) {
+                    prom.resolve();
+                    return fut;
+                }
+
+                size_t min_run = grain ? grain : 4096;
+                size_t runs = 1;
+                while (runs < threadsInPool.size() * 4 && count / (runs * 2) >= min_run)
+                    runs *= 2;
+                auto job = new sort_job<Iter, Compare>(first, count, runs, std::move(comp));
+                job->prom = std::move(prom);
+                start_parts(future_carrier, job, std::min(threadsInPool.size(), runs));
+                return fut;
+            }
+        private:
+            template <typename Index>
+            static inline size_t range_size(Index first, Index last) {
+                return last > first ? static_cast<size_t>(last - first) : 0;
+            }
+            template <typename Index>
+            static inline Index advance(Index first, size_t n) {
+                return static_cast<Index>(first + static_cast<std::iter_difference_t<Index>>(n));
+            }
+            // the element for iterators, the index itself otherwise
+            template <typename Index>
+            static inline decltype(auto) at(Index i) {
+                if constexpr (std::input_or_output_iterator<Index>)
+                    return *i;
+                else
+                    return i;
+            }
+
+            // chunks of [0, count), claimed with a compare and swap. Every claim takes a share of what is left,
+            //  so chunks shrink towards the end, and the threads run out of work at about the same time.
+            struct chunk_claim {
+                std::atomic<size_t> next = 0;
+                size_t count = 0;
+                size_t grain = 1;
+                size_t threads = 1;
+                inline void init(size_t count_, size_t grain_, size_t threads_) {
+                    count = count_;
+                    threads = threads_;
+                    grain = grain_ ? grain_ : std::max<size_t>(1, count / (threads * 64));
+                }
+                inline size_t parts() const {
+                    return std::min(threads, (count + grain - 1) / grain);
+                }
+                inline bool claim(size_t& begin, size_t& end) {
+                    size_t cur = next.load(std::memory_order_relaxed);
+                    while (cur < count) {
+                        size_t take = std::min(count - cur, std::max(grain, (count - cur) / (threads * 2)));
+                        if (next.compare_exchange_weak(cur, cur + take, std::memory_order_relaxed)) {
+                            begin = cur;
+                            end = cur + take;
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+                inline void stop() {
+                    next.store(count, std::memory_order_relaxed);
+                }
+            };
+
+            // one call of a parallel algorithm, shared by its parts. The part that leaves last finishes the job and deletes it.
+            struct parallel_job {
+                std::atomic<size_t> parts = 0;
+                std::atomic<bool> threw = false;
+                std::atomic<bool> dropped = false;     // a part was destroyed unrun, by a manager going away
+                async_promise prom;
+                // void jobs. Dropped, the promise breaks with the job.
+                inline void finish() {
+                    if (threw.load(std::memory_order_relaxed))
+                        prom.reject(std::make_error_code(std::errc::invalid_argument));
+                    else if (!dropped.load(std::memory_order_relaxed))
+                        prom.resolve();
+                }
+            };
+            // the callable of one part, a task node from the carrier posted to a thread of the pool
+            template <typename Job>
+            struct job_part {
+                Job* job;
+                bool ran = false;
+                inline explicit job_part(Job* j) :job(j) {}
+                inline job_part(job_part&& right) noexcept :job(std::exchange(right.job, nullptr)), ran(right.ran) {}
+                job_part(const job_part&) = delete;
+                inline void operator()() {
+#if IO_EXCEPTION_ON
+                    try {
+#endif
+                        job->run();
+#if IO_EXCEPTION_ON
+                    }
+                    catch (...) {
+                        job->threw.store(true, std::memory_order_relaxed);
+                        job->stop();
+                    }
+#endif
+                    ran = true;
+                }
+                inline ~job_part() {
+                    if (job == nullptr)
+                        return;
+                    if (!ran)
+                        job->dropped.store(true, std::memory_order_relaxed);
+                    if (job->parts.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    {
+                        job->finish();
+                        delete job;
+                    }
+                }
+            };
+            template <typename Job>
+            inline void start_parts(manager* carrier, Job* job, size_t parts) {
+                job->parts.store(parts, std::memory_order_relaxed);
+                for (size_t i = 0; i < parts; i++)
+                {
+                    manager* executor = threadsInPool[next_thread++ % threadsInPool.size()].mngr;
+                    executor->push_task(carrier->make_task(job_part<Job>(job)));
+                }
+            }
+
+            template <typename Index, typename Func>
+            struct for_job : parallel_job {
+                Index first;
+                Func func;
+                chunk_claim chunks;
+                inline for_job(Index first_, Func&& func_) :first(first_), func(std::move(func_)) {}
+                inline void run() {
+                    size_t begin, end;
+                    while (chunks.claim(begin, end))
+                    {
+                        if constexpr (std::is_invocable_v<Func&, Index, Index>)
+                            func(advance(first, begin), advance(first, end));
+                        else
+                            for (Index i = advance(first, begin), e = advance(first, end); i != e; ++i)
+                                func(at(i));
+                    }
+                }
+                inline void stop() { chunks.stop(); }
+            };
+
+            template <typename Index, typename T, typename Reduce, typename Transform>
+            struct reduce_job : parallel_job {
+                Index first;
+                T value;
+                Reduce reduce;
+                Transform transform;
+                chunk_claim chunks;
+                std::atomic_flag lock = ATOMIC_FLAG_INIT;
+                manager* carrier = nullptr;
+                T* dest = nullptr;
+                lowlevel::task* back = nullptr;     // a node of the carrier, taken there, which carries the result back
+                inline reduce_job(Index first_, T&& init, Reduce&& reduce_, Transform&& transform_)
+                    :first(first_), value(std::move(init)), reduce(std::move(reduce_)), transform(std::move(transform_)) {}
+                inline void run() {
+                    std::optional<T> partial;
+                    size_t begin, end;
+                    while (chunks.claim(begin, end))
+                    {
+                        for (Index i = advance(first, begin), e = advance(first, end); i != e; ++i)
+                        {
+                            if (partial)
+                                *partial = reduce(std::move(*partial), transform(at(i)));
+                            else
+                                partial.emplace(transform(at(i)));
+                        }
+                    }
+                    if (partial)
+                    {
+                        while (lock.test_and_set(std::memory_order_acquire));
+                        value = reduce(std::move(value), std::move(*partial));
+                        lock.clear(std::memory_order_release);
+                    }
+                }
+                inline void stop() { chunks.stop(); }
+                inline void finish() {
+                    if (threw.load(std::memory_order_relaxed) || dropped.load(std::memory_order_relaxed))
+                    {
+                        parallel_job::finish();
+                        manager::fill_task(back, []() {});     // the node goes home empty
+                        carrier->push_task(back);
+                        return;
+                    }
+                    manager::send_result(carrier, back, dest, std::move(value), std::move(prom));
+                }
+            };
+
+            // runs: a complete binary tree over the runs, heap numbered. Run r is node runs + r, the root is node 1.
+            //  arrivals[node] counts its children that are done, the second one merges them.
+            template <typename Iter, typename Compare>
+            struct sort_job : parallel_job {
+                Iter first;
+                size_t count;
+                size_t runs;
+                Compare comp;
+                std::atomic<size_t> next_run = 0;
+                std::unique_ptr<std::atomic<unsigned char>[]> arrivals;
+                inline sort_job(Iter first_, size_t count_, size_t runs_, Compare&& comp_)
+                    :first(first_), count(count_), runs(runs_), comp(std::move(comp_)), arrivals(new std::atomic<unsigned char>[runs_]()) {}
+                inline Iter run_begin(size_t r) { return advance(first, count * r / runs); }
+                inline void run() {
+                    size_t r;
+                    while ((r = next_run.fetch_add(1, std::memory_order_relaxed)) < runs)
+                    {
+                        std::sort(run_begin(r), run_begin(r + 1), comp);
+                        size_t node = runs + r;
+                        size_t width = 1;   // runs under node
+                        while (node > 1)
+                        {
+                            node /= 2;
+                            if (arrivals[node].fetch_add(1, std::memory_order_acq_rel) == 0)
+                                break;      // the other half is not done yet, its thread merges
+                            width *= 2;
+                            size_t left = node * width - runs;
+                            std::inplace_merge(run_begin(left), run_begin(left + width / 2), run_begin(left + width), comp);
+                        }
+                    }
+                }
+                inline void stop() { next_run.store(runs, std::memory_order_relaxed); }
+            };
+        public:
             
             /**
              * Stops all threads in the pool and clears the pool
@@ -1480,7 +2834,7 @@ namespace io
                 
                 for (auto& t : threadsInPool) {
                     t.stopFlag.test_and_set(std::memory_order_release);
-                    t.mngr.wakeup();
+                    t.mngr->wakeup();
                 }
                 
                 for (auto& t : threadsInPool) {
@@ -1501,14 +2855,28 @@ namespace io
                     return;
                 }
                 
-                manager* target_manager = &(threadsInPool[next_thread % threadsInPool.size()].mngr);
+                manager* target_manager = threadsInPool[next_thread % threadsInPool.size()].mngr;
                 next_thread++;
                 
                 target_manager->async_spawn(std::move(new_fsm));
             }
+            /**
+             * Spawns a coroutine on a thread on the node, or pinned to the CPU, or owning the key, of the hint
+             *  The coroutine frame was allocated by the calling thread, only what it allocates later is local.
+             */
+            template <typename T_spawn>
+            inline void async_spawn(hint where, fsm_func<T_spawn> new_fsm) {
+                if (threadsInPool.empty()) {
+                    return;
+                }
+                pick(where)->async_spawn(std::move(new_fsm));
+            }
 
             manager* getManager() {
-                return &(threadsInPool[next_thread++ % threadsInPool.size()].mngr);
+                return threadsInPool[next_thread++ % threadsInPool.size()].mngr;
+            }
+            manager* getManager(hint where) {
+                return pick(where);
             }
             
             /**
@@ -1517,6 +2885,124 @@ namespace io
 			inline explicit pool(size_t thread_count = 1) {
                 threadsInPool.resize(thread_count);
             }
+            /**
+             * Creates a pool whose threads spin before they suspend, see manager::set_busy_poll
+             */
+            inline pool(size_t thread_count, const busy_poll_options& options) {
+                placement.busy_poll = options;
+                resize(thread_count);
+            }
+            /**
+             * Creates a pool pinned to CPUs or NUMA nodes, see options
+             * Every thread makes its own manager once it's pinned, so the manager's memory is local to it.
+             */
+            inline explicit pool(const options& opts) : placement(opts) {
+                balancing = opts.balance;
+                resize(opts.threads ? opts.threads : std::max<size_t>(placement_set().size(), 1));
+            }
+            /**
+             * Grows or shrinks the pool to thread_count threads, new ones are placed as the options of the pool say
+             *  Keys move consistently, see by_key: growing moves about 1 / thread_count of them, all to the new threads.
+             *  Shrinking moves the keys of the removed threads only.
+             * Not thread safe: nothing else may use the pool meanwhile. The threads removed are the last ones, they are stopped:
+             *  tasks posted to them that didn't run are dropped, and their coroutines are lost. Drain them first.
+             */
+            inline void resize(size_t thread_count) {
+                while (threadsInPool.size() > thread_count)
+                    threadsInPool.pop_back();
+                if (threadsInPool.size() == thread_count)
+                    return;
+                const cpu_topology& topology = cpu_topology::get();
+                std::vector<int> set = placement_set();
+                std::vector<int> nodes;
+                for (int cpu : set)
+                    if (nodes.empty() || nodes.back() != topology.node_of(cpu))
+                        nodes.push_back(topology.node_of(cpu));
+
+                for (size_t i = threadsInPool.size(); i < thread_count; i++) {
+                    std::vector<int> cpus;
+                    int node = -1;
+                    if (placement.affinity == affinity::cpu && !set.empty()) {
+                        cpus.push_back(set[i % set.size()]);
+                        node = topology.node_of(cpus.back());
+                    }
+                    else if (placement.affinity == affinity::node && !nodes.empty()) {
+                        // in turn, like the CPUs: where thread i goes doesn't depend on the thread count, so resize places
+                        //  new threads as the constructor would, and never has to move the old ones.
+                        node = nodes[i % nodes.size()];
+                        for (int cpu : set)
+                            if (topology.node_of(cpu) == node)
+                                cpus.push_back(cpu);
+                    }
+                    threadsInPool.emplace_back(placement.busy_poll, std::move(cpus), node);
+                }
+            }
+            /**
+             * Busy polling counters summed over the threads, spin_budget is their mean
+             */
+            inline busy_poll_stats get_busy_poll_stats() const {
+                busy_poll_stats sum;
+                for (auto& t : threadsInPool) {
+                    auto st = t.mngr->get_busy_poll_stats();
+                    sum.spinning += st.spinning;
+                    sum.sleeping += st.sleeping;
+                    sum.spin_wakes += st.spin_wakes;
+                    sum.sleeps += st.sleeps;
+                    sum.spin_budget += st.spin_budget;
+                }
+                if (threadsInPool.size())
+                    sum.spin_budget /= threadsInPool.size();
+                return sum;
+            }
+            
+            /**
+             * Busy fraction of every thread's drive loop, 0 to 1, over the last sample window
+             *  Sampled from manager::idle_time at most once per balance_options::window, by this or balance_target.
+             */
+            inline std::vector<double> loads() {
+                sample_loads();
+                std::vector<double> ret;
+                for (auto& t : threadsInPool)
+                    ret.push_back(t.load.load(std::memory_order_relaxed) / 1000.0);
+                return ret;
+            }
+            inline void set_balance(const balance_options& options) {
+                balancing = options;
+            }
+            /**
+             * The manager a coroutine running on current should move to: the least busy thread,
+             *  if current's thread is saturated and that one is at least the margin less busy. Otherwise nullptr
+             */
+            inline manager* balance_target(manager* current) {
+                if (threadsInPool.size() < 2)
+                    return nullptr;
+                sample_loads();
+                _thread* from = nullptr;
+                _thread* to = nullptr;
+                for (auto& t : threadsInPool) {
+                    if (t.mngr == current)
+                        from = &t;
+                    if (to == nullptr || t.load.load(std::memory_order_relaxed) < to->load.load(std::memory_order_relaxed))
+                        to = &t;
+                }
+                if (from == nullptr || from == to)
+                    return nullptr;
+                int from_load = from->load.load(std::memory_order_relaxed);
+                if (from_load < int(balancing.saturated * 1000) ||
+                    from_load - to->load.load(std::memory_order_relaxed) < int(balancing.margin * 1000))
+                    return nullptr;
+                from->load.fetch_sub(int(balancing.step * 1000), std::memory_order_relaxed);
+                to->load.fetch_add(int(balancing.step * 1000), std::memory_order_relaxed);
+                return to->mngr;
+            }
+            /**
+             * co_await workers.rebalance(fsm.getManager(), futures...) in a coroutine of this pool, where it holds no pending future:
+             *  moves it off a saturated thread, see balance_target and io::migrate_to. A no-op otherwise.
+             */
+            template <typename ...Futs>
+            inline auto rebalance(manager* current, Futs&... futs) {
+                return io::migrate_to(balance_target(current), futs...);
+            }
             
             /**
              * Checks if the pool is currently running
@@ -1528,6 +3014,53 @@ namespace io
             inline ~pool() {
                 stop();
             }
+        private:
+            options placement;                          // how threads are placed, see resize
+            balance_options balancing;
+            std::atomic_flag sampling = ATOMIC_FLAG_INIT;
+            std::atomic<int64_t> sampled_at = 0;        // steady clock, ns. 0: not sampled yet
+
+            // one caller at a time recomputes the loads, once the window passed.
+            inline void sample_loads() {
+                int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+                int64_t window = std::chrono::duration_cast<std::chrono::nanoseconds>(balancing.window).count();
+                if (now - sampled_at.load(std::memory_order_relaxed) < window || sampling.test_and_set(std::memory_order_acquire))
+                    return;
+                int64_t last = sampled_at.load(std::memory_order_relaxed);
+                if (now - last >= window) {
+                    for (auto& t : threadsInPool) {
+                        int64_t idle = t.mngr->idle_time().count();
+                        if (last != 0) {
+                            double busy = 1.0 - double(idle - t.sampled_idle) / double(now - last);
+                            t.load.store(std::clamp(int(busy * 1000), 0, 1000), std::memory_order_relaxed);
+                        }
+                        t.sampled_idle = idle;
+                    }
+                    sampled_at.store(now, std::memory_order_relaxed);
+                }
+                sampling.clear(std::memory_order_release);
+            }
+            // the CPU set of placement, sorted by node
+            inline std::vector<int> placement_set() const {
+                const cpu_topology& topology = cpu_topology::get();
+                std::vector<int> set = placement.cpus.empty() ? topology.allowed : placement.cpus;
+                std::stable_sort(set.begin(), set.end(), [&](int a, int b) { return topology.node_of(a) < topology.node_of(b); });
+                return set;
+            }
+            inline manager* pick(hint where) {
+                if (threadsInPool.empty())
+                    return nullptr;
+                if (where.keyed)
+                    return threadsInPool[shard_of(where.key, threadsInPool.size())].mngr;
+                size_t start = next_thread++;
+                for (size_t i = 0; i < threadsInPool.size(); i++) {
+                    _thread& t = threadsInPool[(start + i) % threadsInPool.size()];
+                    if ((where.node >= 0 && t.node == where.node) ||
+                        (where.cpu >= 0 && std::find(t.cpus.begin(), t.cpus.end(), where.cpu) != t.cpus.end()))
+                        return t.mngr;
+                }
+                return threadsInPool[start % threadsInPool.size()].mngr;
+            }
         };
         
         //dynamic combinator for combining futures dynamically
@@ -1590,6 +3123,7 @@ namespace io
             // Push future with value
             template <typename U>
             inline void push(future&& fut, U&& value) requires (!std::is_same_v<T, void>) {
+                own_awaiter(fut);
                 auto result = values.emplace(fut.awaiter, std::forward<U>(value));
                 IO_ASSERT(result.second, "dynamic_combinator ERROR: Awaiter already exists in values map.");
 
@@ -1606,6 +3140,7 @@ namespace io
             }
             
             inline void push(future&& fut) {
+                own_awaiter(fut);
                 // Store the value if T is not void
                 if constexpr (!std::is_same_v<T, void>) {
                     auto result = values.emplace(fut.awaiter, _Type{});
@@ -1719,6 +3254,11 @@ namespace io
             dynamic_combinator& operator=(dynamic_combinator&&) = default;
             
         private:
+            // a ready future shares its awaiter, the values map needs one of its own.
+            inline void own_awaiter(future& fut) {
+                if (fut.awaiter->bit_set & lowlevel::awaiter::is_ready)
+                    manager_ptr->make_future(fut).resolve();
+            }
             inline void initialize_coro_set() {
                 // Create the lambda that will be called when any awaiter completes
                 coro_set = [this](lowlevel::awaiter* awa) {
@@ -1871,6 +3411,38 @@ namespace io
                                     std::declval<typename output_trait<Front_prot_output_type, Adapter>::type&>()))> >
                     : std::true_type {};
 
+                // Check if T has void operator>>(future_with<std::vector<prot_output_type>>&)
+                template <typename T, typename = void>
+                struct has_batch_output_op : std::false_type {};
+
+                template <typename T>
+                struct has_batch_output_op<T,
+                                std::void_t<decltype(std::declval<T>().operator>>(
+                                    std::declval<future_with<std::vector<std::enable_if_t<has_prot_output_type<T>::value &&
+                                    !is_prot_recv_void<T>::value, typename T::prot_output_type>>>&>()))> >
+                    : std::true_type {};
+
+                // Check if T has U operator<<(std::span<prot_input_type>) where U is convertible to io::future
+                template <typename T, typename Front_prot_output_type, typename = void>
+                struct has_batch_future_send_op : std::false_type {};
+
+                template <typename T, typename Front_prot_output_type>
+                struct has_batch_future_send_op<T, Front_prot_output_type,
+                                std::void_t<decltype(
+                                    std::declval<io::future&>() = std::declval<T>().operator<<(
+                                        std::declval<std::span<Front_prot_output_type>>()))> >
+                    : std::true_type {};
+
+                // Check if T has void operator<<(std::span<prot_input_type>)
+                template <typename T, typename Front_prot_output_type, typename = void>
+                struct has_batch_void_send_op : std::false_type {};
+
+                template <typename T, typename Front_prot_output_type>
+                struct has_batch_void_send_op<T, Front_prot_output_type,
+                                std::void_t<decltype(std::declval<T>().operator<<(
+                                    std::declval<std::span<Front_prot_output_type>>()))> >
+                    : std::true_type {};
+
                 template <typename T>
                 struct movable_future_with :future_with<T> {
                     movable_future_with() {}
@@ -1903,6 +3475,22 @@ namespace io
                 static constexpr bool await = detail::has_future_send_op<T, Front_prot_output_type, Adapter>::value;
             };
 
+            // Optional batch protocol: many items per round trip.
+            // Output: void operator>>(future_with<std::vector<prot_output_type>>&), resolves with at least one item.
+            // Input: future (or void) operator<<(std::span<prot_input_type>).
+            template <typename T>
+            struct is_batch_output_prot {
+                static constexpr bool value = detail::has_batch_output_op<T>::value;
+            };
+
+            template <typename T, typename Front_prot_output_type>
+            struct is_batch_input_prot {
+                static constexpr bool value =
+                    (detail::has_batch_future_send_op<T, Front_prot_output_type>::value ||
+                     detail::has_batch_void_send_op<T, Front_prot_output_type>::value);
+                static constexpr bool await = detail::has_batch_future_send_op<T, Front_prot_output_type>::value;
+            };
+
             template <typename T, typename = void>
             inline constexpr bool is_pipeline_v = false;
 
@@ -1915,21 +3503,24 @@ namespace io
                 std::enable_if_t<std::is_same_v<T, pipeline<
                 typename T::Front_t,
                 typename T::Rear_t,
-                typename T::Adaptor_t>>>
+                typename T::Adaptor_t,
+                T::depth>>>
                 >> = true;
 
             template <typename T>
             struct is_output_prot_gen {
                 static constexpr bool value = is_output_prot<T>::value;
                 static constexpr bool await = is_output_prot<T>::await;
+                static constexpr bool batch = is_batch_output_prot<T>::value;
                 static constexpr bool is_pipeline = false;
                 using prot_output_type = typename T::prot_output_type;
             };
 
-            template <typename Front, typename Rear, typename Adaptor>
-            struct is_output_prot_gen<pipeline<Front, Rear, Adaptor>> {
+            template <typename Front, typename Rear, typename Adaptor, size_t Depth>
+            struct is_output_prot_gen<pipeline<Front, Rear, Adaptor, Depth>> {
                 static constexpr bool value = is_output_prot<std::remove_reference_t<Rear>>::value;
                 static constexpr bool await = is_output_prot<std::remove_reference_t<Rear>>::await;
+                static constexpr bool batch = is_batch_output_prot<std::remove_reference_t<Rear>>::value;
                 static constexpr bool is_pipeline = true;
                 using prot_output_type = typename std::remove_reference_t<Rear>::prot_output_type;
             };
@@ -1999,6 +3590,12 @@ namespace io
 
         // -------------------------------this manager-----------------------------------------
         inline manager* this_manager() {return lowlevel::this_thread;}
+        // manager::now() of this thread's manager, steady_clock::now() outside of a manager.
+        inline std::chrono::steady_clock::time_point now() {
+            if (lowlevel::this_thread != nullptr)
+                return lowlevel::this_thread->now();
+            return std::chrono::steady_clock::now();
+        }
         constexpr const char* outside_manager_error_msg = 
             "io::manager ERROR: manager function must be called from within a manager context.";
 #if IO_USE_ASIO
@@ -2065,6 +3662,14 @@ namespace io
             );
             return io::lowlevel::this_thread->make_outdated_clock(fut, isResolve);
         }
+        template <typename T_Duration>
+        inline void make_periodic(periodic& fut, T_Duration period, periodic_mode mode) {
+            IO_ASSERT(
+                io::lowlevel::this_thread != nullptr,
+                outside_manager_error_msg
+            );
+            return io::lowlevel::this_thread->make_periodic(fut, period, mode);
+        }
         inline async_promise make_future(async_future& fut) {
             IO_ASSERT(
                 io::lowlevel::this_thread != nullptr,
@@ -2072,6 +3677,13 @@ namespace io
             );
             return io::lowlevel::this_thread->make_future(fut);
         }
+        inline void make_ready_future(future& fut) {
+            IO_ASSERT(
+                io::lowlevel::this_thread != nullptr,
+                outside_manager_error_msg
+            );
+            io::lowlevel::this_thread->make_ready_future(fut);
+        }
         template <typename T_spawn>
         [[nodiscard]] inline io::fsm_handle<T_spawn> spawn_now(fsm_func<T_spawn> new_fsm) {
             IO_ASSERT(
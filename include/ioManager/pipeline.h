@@ -4,12 +4,98 @@
 namespace io {
     inline namespace IO_LIB_VERSION___ {
 
-        template <typename Front = void, typename Rear = void, typename Adaptor = void>
+        // keeps up to N outputs of the front protocol in flight in a segment: a >> io::in_flight<N> >> b
+        template <size_t N>
+            requires (N > 0)
+        struct in_flight_t {};
+        template <size_t N>
+        inline constexpr in_flight_t<N> in_flight{};
+
+        // HDR style histogram of nanoseconds: 16 linear buckets per power of two (about 6% precision),
+        // exact below 32 ns, values above 2^40 ns are counted in the last bucket.
+        struct latency_histogram {
+            static constexpr size_t sub_bits = 4;
+            static constexpr size_t sub_count = 1 << sub_bits;
+            static constexpr size_t max_bits = 40;
+            static constexpr size_t bucket_count = (max_bits - sub_bits + 1) * sub_count;
+
+            inline void record(uint64_t ns, uint64_t times = 1) {
+                buckets[index_of(ns)] += times;
+                total += times;
+                sum += ns * times;
+                min_ns = std::min(min_ns, ns);
+                max_ns = std::max(max_ns, ns);
+            }
+            inline uint64_t count() const { return total; }
+            inline std::chrono::nanoseconds min() const { return std::chrono::nanoseconds(total ? min_ns : 0); }
+            inline std::chrono::nanoseconds max() const { return std::chrono::nanoseconds(max_ns); }
+            inline std::chrono::nanoseconds mean() const { return std::chrono::nanoseconds(total ? sum / total : 0); }
+            // p in [0, 100]: the highest value of the bucket that holds the p-th percentile.
+            inline std::chrono::nanoseconds percentile(double p) const {
+                if (total == 0)
+                    return std::chrono::nanoseconds(0);
+                uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(p / 100 * total + 0.5));
+                uint64_t seen = 0;
+                for (size_t i = 0; i < bucket_count; i++) {
+                    seen += buckets[i];
+                    if (seen >= target)
+                        return std::chrono::nanoseconds(std::min(highest_of(i), max_ns));
+                }
+                return max();
+            }
+
+        private:
+            inline static size_t index_of(uint64_t ns) {
+                if (ns < 2 * sub_count)
+                    return ns;
+                size_t shift = std::bit_width(ns) - sub_bits - 1;
+                if (shift > max_bits - sub_bits - 1)
+                    return bucket_count - 1;
+                return (shift + 1) * sub_count + ((ns >> shift) - sub_count);
+            }
+            inline static uint64_t highest_of(size_t index) {
+                if (index < 2 * sub_count)
+                    return index;
+                size_t shift = index / sub_count - 1;
+                return ((index % sub_count + sub_count + 1) << shift) - 1;
+            }
+
+            std::array<uint64_t, bucket_count> buckets{};
+            uint64_t total = 0;
+            uint64_t sum = 0;
+            uint64_t min_ns = UINT64_MAX;
+            uint64_t max_ns = 0;
+        };
+
+        // counters of one pipeline segment, recorded when IO_USE_PIPELINE_STATS is 1.
+        struct pipeline_stats {
+            uint64_t items_in = 0;      // items taken from the front protocol
+            uint64_t items_out = 0;     // items handed to the rear protocol, an adaptor may drop some
+            uint64_t errors = 0;        // rejected futures of both sides
+            std::chrono::nanoseconds front_wait{ 0 };   // time the segment waited for the front's output
+            std::chrono::nanoseconds rear_wait{ 0 };    // time the segment waited for the rear's operator<<
+            latency_histogram latency;  // from an item leaving the front until the rear accepted it
+        };
+
+        template <typename Front = void, typename Rear = void, typename Adaptor = void, size_t Depth = 1>
         struct pipeline {
             __IO_INTERNAL_HEADER_PERMISSION;
             using Rear_t = Rear;
             using Front_t = Front;
             using Adaptor_t = Adaptor;
+            static constexpr size_t depth = Depth;
+            // the segment moves batches when both protocols support it, it has no adaptor and depth 1.
+            static constexpr bool batch = [] {
+                if constexpr (std::is_void_v<Rear>) {
+                    return false;
+                }
+                else {
+                    return Depth == 1 && std::is_void_v<Adaptor> &&
+                        trait::is_output_prot_gen<std::remove_reference_t<Front>>::batch &&
+                        trait::is_batch_input_prot<std::remove_reference_t<Rear>, typename trait::is_output_prot_gen<
+                        std::remove_reference_t<Front>>::prot_output_type>::value;
+                }
+                }();
 
             inline decltype(auto) start()&& {
                 return pipeline_started<std::remove_reference_t<decltype(*this)>, false,
@@ -25,33 +111,39 @@ namespace io {
             }
 
             template <typename T_FSM> inline decltype(auto) spawn(T_FSM& _fsm)&& {
+                pipeline* inner = nullptr;
                 pipeline_started<std::remove_reference_t<decltype(*this)>, true,
                     std::monostate>
-                    ret = _fsm.spawn_now([](decltype(*this) t) -> fsm_func<void> {
+                    ret = _fsm.spawn_now([](decltype(*this) t, pipeline** inner) -> fsm_func<void> {
                     pipeline_started<std::remove_reference_t<decltype(*this)>, false,
                     std::monostate>
                     pipeline_s(std::move(t));
+                *inner = &pipeline_s._pipeline;
                 while (1) {
                     pipeline_s <= co_await +pipeline_s;
                 }
-                        }(*this));
+                        }(*this, &inner));
+                ret.set_inner(inner);
                 return ret;
             }
 
             template <typename T_FSM, typename ErrorHandler>
                 requires trait::PipelineErrorHandler<ErrorHandler>
             inline decltype(auto) spawn(T_FSM& _fsm, ErrorHandler&& e)&& {
+                pipeline* inner = nullptr;
                 pipeline_started<std::remove_reference_t<decltype(*this)>, true,
                     std::monostate>
                     ret = _fsm.spawn_now(
-                        [](decltype(*this) t, ErrorHandler&& e) -> fsm_func<void> {
+                        [](decltype(*this) t, ErrorHandler&& e, pipeline** inner) -> fsm_func<void> {
                             pipeline_started<std::remove_reference_t<decltype(*this)>, false,
                             ErrorHandler>
                             pipeline_s(std::move(t), std::forward<ErrorHandler>(e));
+                *inner = &pipeline_s._pipeline;
                 while (1) {
                     pipeline_s <= co_await +pipeline_s;
                 }
-                        }(*this, std::forward<ErrorHandler>(e)));
+                        }(*this, std::forward<ErrorHandler>(e), &inner));
+                ret.set_inner(inner);
                 return ret;
             }
 
@@ -85,10 +177,18 @@ namespace io {
                     std::conditional_t<
                     std::is_lvalue_reference_v<T>,
                     std::add_lvalue_reference_t<std::remove_reference_t<T>>,
-                    std::remove_reference_t<T>>>(std::move(*this),
+                    std::remove_reference_t<T>>, 1>(std::move(*this),
                         std::forward<T>(adaptor));
             }
 
+            // in-flight depth of the next segment
+            template <size_t N>
+                requires(trait::is_output_prot<std::remove_reference_t<Rear>>::value)
+            inline decltype(auto) operator>>(in_flight_t<N>)&& {
+                return pipeline_constructor<
+                    std::remove_reference_t<decltype(*this)>, void, void, N>(std::move(*this));
+            }
+
             consteval static size_t pair_sum() {
                 if constexpr (trait::is_pipeline_v<std::remove_reference_t<Front>>) {
                     return Front::pair_sum() + 1;
@@ -98,6 +198,16 @@ namespace io {
                 }
             }
 
+            // slots of the wait set: a segment with depth > 1 waits on its front and its rear together
+            consteval static size_t slot_sum() {
+                if constexpr (trait::is_pipeline_v<std::remove_reference_t<Front>>) {
+                    return Front::slot_sum() + (Depth > 1 ? 2 : 1);
+                }
+                else {
+                    return Depth > 1 ? 2 : 1;
+                }
+            }
+
             pipeline(pipeline&) = delete;
             void operator=(pipeline&) = delete;
 
@@ -105,23 +215,126 @@ namespace io {
             pipeline& operator=(pipeline&&) = default;
 
         private:
-            inline decltype(auto) awaitable() {
-                std::array<future*, pair_sum()> futures;
+            // persistent wait set: every segment registers its futures once, until they settle.
+            // Completions come back as slot indexes, step() advances only the segment of that slot.
+            static constexpr size_t own_slots = Depth > 1 ? 2 : 1;
+
+            template <typename WaitSet>
+            inline void arm_all(WaitSet& ws) {
+                if constexpr (trait::is_pipeline_v<std::remove_reference_t<Front>>) {
+                    front.arm_all(ws);
+                }
+                probe_tick();
+                arm(ws);
+            }
+
+            template <typename WaitSet>
+            inline void arm(WaitSet& ws) {
+                std::array<future*, own_slots> futures;
                 size_t index = 0;
                 await_get(futures, index);
-                if constexpr (pair_sum() == 1) {
-                    future& ref = *futures[0];
-                    return future::race_index(ref);
+                for (size_t i = 0; i < own_slots; i++)
+                    ws.add(slot_sum() - own_slots + i, futures[i]);
+            }
+
+            // O(1) dispatch: a table of one function per slot, resolved at compile time.
+            template <typename ErrorHandler, typename WaitSet>
+            inline void step(int slot, ErrorHandler errorHandler, WaitSet& ws) {
+                static constexpr auto table = []<size_t... I>(std::index_sequence<I...>) {
+                    return std::array<void (*)(pipeline&, ErrorHandler&, WaitSet&), sizeof...(I)>{
+                        &pipeline::template step_slot<I, ErrorHandler, WaitSet>... };
+                }(std::make_index_sequence<slot_sum()>{});
+                table[slot](*this, errorHandler, ws);
+            }
+
+            template <size_t Slot, typename ErrorHandler, typename WaitSet>
+            inline static void step_slot(pipeline& p, ErrorHandler& errorHandler, WaitSet& ws) {
+                if constexpr (Slot >= slot_sum() - own_slots) {
+                    p.probe_tick();
+                    p.process(Slot - (slot_sum() - own_slots), errorHandler);
+                    p.arm(ws);
                 }
                 else {
-                    return std::apply([](auto &&...args) { return future::race_index(*args...); },
-                        futures);
+                    std::remove_reference_t<Front>::template step_slot<Slot, ErrorHandler, WaitSet>(p.front, errorHandler, ws);
                 }
             }
 
+            // copies the counters of every segment, index pair_sum() - 1 of each segment.
+            template <size_t N>
+            inline void collect(std::array<pipeline_stats, N>& out) const {
+                if constexpr (trait::is_pipeline_v<std::remove_reference_t<Front>>) {
+                    front.collect(out);
+                }
+                out[pair_sum() - 1] = probe.stats;
+            }
+
+            // Instrumentation, compiled out unless IO_USE_PIPELINE_STATS is 1.
+            // One clock read per step, the other probes reuse it, except after a synchronous operator<<.
+            inline static uint64_t probe_clock() {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+            }
+            inline void probe_tick() {
+                if constexpr (IO_USE_PIPELINE_STATS) {
+                    probe.now = probe_clock();
+                }
+            }
+            inline void probe_front_issued() {
+                if constexpr (IO_USE_PIPELINE_STATS) {
+                    probe.front_since = probe.now;
+                }
+            }
+            // pos: ring position of the item when the segment has depth > 1
+            inline void probe_front_settled(bool ok, size_t items = 1, size_t pos = 0) {
+                if constexpr (IO_USE_PIPELINE_STATS) {
+                    probe.stats.front_wait += std::chrono::nanoseconds(probe.now - probe.front_since);
+                    probe_front_ready(ok, items, pos);
+                }
+            }
+            // a direct output protocol: the item is ready without waiting
+            inline void probe_front_ready(bool ok = true, size_t items = 1, size_t pos = 0) {
+                if constexpr (IO_USE_PIPELINE_STATS) {
+                    if (ok) {
+                        probe.stats.items_in += items;
+                        probe.ready_at[pos] = probe.now;
+                    }
+                    else {
+                        probe.stats.errors++;
+                    }
+                }
+            }
+            inline void probe_rear_issued(size_t items = 1) {
+                if constexpr (IO_USE_PIPELINE_STATS) {
+                    probe.stats.items_out += items;
+                    probe.rear_since = probe.now;
+                }
+            }
+            inline void probe_rear_settled(bool ok, size_t items = 1, size_t pos = 0) {
+                if constexpr (IO_USE_PIPELINE_STATS) {
+                    probe.stats.rear_wait += std::chrono::nanoseconds(probe.now - probe.rear_since);
+                    if (!ok)
+                        probe.stats.errors++;
+                    probe.stats.latency.record(probe.now - probe.ready_at[pos], items);
+                }
+            }
+            // a direct input protocol: the item is accepted when operator<< returns
+            inline void probe_rear_done(size_t items = 1) {
+                if constexpr (IO_USE_PIPELINE_STATS) {
+                    probe.stats.items_out += items;
+                    probe.stats.latency.record(probe_clock() - probe.ready_at[0], items);
+                }
+            }
+
+            // local: slot of this segment, 0 or 1.
             template <typename ErrorHandler>
-            inline void process(int which, ErrorHandler errorHandler) {
-                if (which == this->pair_sum() - 1) {
+            inline void process(int local, ErrorHandler& errorHandler) {
+                if constexpr (Depth > 1) {
+                    depth_process(local, errorHandler);
+                }
+                else if constexpr (batch) {
+                    batch_process(errorHandler);
+                }
+                else {
                     if constexpr (trait::is_output_prot_gen<
                         std::remove_reference_t<Front>>::await &&
                         trait::is_input_prot<
@@ -130,10 +343,11 @@ namespace io {
                         std::remove_reference_t<Front>>::prot_output_type,
                         Adaptor>::await) {
                         if (turn == 1) {
+                            probe_front_settled(!front_future.getErr());
                             if (front_future.getErr()) {
                                 if constexpr (std::is_same_v<ErrorHandler, std::monostate> ==
                                     false) {
-                                    errorHandler(which, true, front_future.getErr());
+                                    errorHandler(pair_sum() - 1, true, front_future.getErr());
                                 }
                                 turn = 0;
                             }
@@ -142,6 +356,7 @@ namespace io {
                                     auto adapted_data = adaptor(front_future.data);
                                     if (adapted_data) {
                                         rear_future = rear << *adapted_data;
+                                        probe_rear_issued();
                                         turn = 3;
                                     }
                                     else {
@@ -152,20 +367,23 @@ namespace io {
                                         else {
                                             front >> front_future;
                                         }
+                                        probe_front_issued();
                                         turn = 1;
                                     }
                                 }
                                 else {
                                     rear_future = rear << front_future.data;
+                                    probe_rear_issued();
                                     turn = 3;
                                 }
                             }
                         }
                         else if (turn == 3) {
+                            probe_rear_settled(!rear_future.getErr());
                             if (rear_future.getErr()) {
                                 if constexpr (std::is_same_v<ErrorHandler, std::monostate> ==
                                     false) {
-                                    errorHandler(which, false, rear_future.getErr());
+                                    errorHandler(pair_sum() - 1, false, rear_future.getErr());
                                 }
                             }
                             turn = 0;
@@ -177,10 +395,11 @@ namespace io {
                     else if constexpr (trait::is_output_prot_gen<
                         std::remove_reference_t<Front>>::await) {
                         if (turn == 1) {
+                            probe_front_settled(!front_future.getErr());
                             if (front_future.getErr()) {
                                 if constexpr (std::is_same_v<ErrorHandler, std::monostate> ==
                                     false) {
-                                    errorHandler(which, true, front_future.getErr());
+                                    errorHandler(pair_sum() - 1, true, front_future.getErr());
                                 }
                                 turn = 0;
                             }
@@ -189,10 +408,12 @@ namespace io {
                                     auto adapted_data = adaptor(front_future.data);
                                     if (adapted_data) {
                                         rear << *adapted_data;
+                                        probe_rear_done();
                                     }
                                 }
                                 else {
                                     rear << front_future.data;
+                                    probe_rear_done();
                                 }
                             }
                             turn = 0;
@@ -208,10 +429,11 @@ namespace io {
                         prot_output_type,
                         Adaptor>::await) {
                         if (turn == 3) {
+                            probe_rear_settled(!rear_future.getErr());
                             if (rear_future.getErr()) {
                                 if constexpr (std::is_same_v<ErrorHandler, std::monostate> ==
                                     false) {
-                                    errorHandler(which, false, rear_future.getErr());
+                                    errorHandler(pair_sum() - 1, false, rear_future.getErr());
                                 }
                             }
                             turn = 2;
@@ -221,22 +443,18 @@ namespace io {
                         }
                     }
                 }
-                else {
-                    if constexpr (trait::is_pipeline_v<std::remove_reference_t<Front>>) {
-                        front.process(which, errorHandler);
-                    }
-                    else {
-                        IO_ASSERT(false, "pipeline ERROR: unexcepted pipeline num!");
-                    }
-                }
             }
 
+            // issues the next futures of this segment. nullptr: the slot waits for nothing.
             template <size_t N>
             inline void await_get(std::array<future*, N>& futures, size_t& index) {
-                if constexpr (trait::is_pipeline_v<std::remove_reference_t<Front>>) {
-                    front.await_get(futures, index);
+                if constexpr (Depth > 1) {
+                    depth_await_get(futures, index);
+                }
+                else if constexpr (batch) {
+                    batch_await_get(futures, index);
                 }
-                if constexpr (trait::is_output_prot_gen<
+                else if constexpr (trait::is_output_prot_gen<
                     std::remove_reference_t<Front>>::await &&
                     trait::is_input_prot<
                     std::remove_reference_t<Rear>,
@@ -250,6 +468,7 @@ namespace io {
                         else {
                             front >> front_future;
                         }
+                        probe_front_issued();
                         futures[index++] = std::addressof(front_future);
                         turn = 1;
                     }
@@ -272,6 +491,7 @@ namespace io {
                         else {
                             front >> front_future;
                         }
+                        probe_front_issued();
                         futures[index++] = std::addressof(front_future);
                         turn = 1;
                     }
@@ -299,9 +519,11 @@ namespace io {
                                 else {
                                     front >> front_future;
                                 }
+                                probe_front_ready();
                                 auto adapted_data = adaptor(front_future);
                                 if (adapted_data) {
                                     rear_future = rear << *adapted_data;
+                                    probe_rear_issued();
                                     adapted = true;
                                 }
                             }
@@ -313,7 +535,9 @@ namespace io {
                             else {
                                 front >> front_future;
                             }
+                            probe_front_ready();
                             rear_future = rear << front_future;
+                            probe_rear_issued();
                         }
 
                         futures[index++] = std::addressof(rear_future);
@@ -338,6 +562,131 @@ namespace io {
                 }
             }
 
+            inline void front_issue() {
+                if constexpr (trait::is_pipeline_v<std::remove_reference_t<Front>>) {
+                    front.rear >> front_future;
+                }
+                else {
+                    front >> front_future;
+                }
+            }
+
+            // depth > 1: the outputs of front wait in a ring, rear consumes them in order.
+            template <size_t N>
+            inline void depth_await_get(std::array<future*, N>& futures, size_t& index) {
+                static_assert(trait::is_output_prot_gen<std::remove_reference_t<Front>>::await &&
+                    trait::is_input_prot<
+                    std::remove_reference_t<Rear>,
+                    typename trait::is_output_prot_gen<
+                    std::remove_reference_t<Front>>::prot_output_type,
+                    Adaptor>::await,
+                    "pipeline ERROR: io::in_flight needs an awaitable output protocol and an "
+                    "awaitable input protocol in the segment!");
+                while (!ring.rear_pending && ring.count) {
+                    auto& head = *ring.slots[ring.head];
+                    if constexpr (!std::is_void_v<Adaptor>) {
+                        auto adapted_data = adaptor(head);
+                        if (adapted_data) {
+                            rear_future = rear << *adapted_data;
+                            probe_rear_issued();
+                            ring.rear_pending = true;
+                        }
+                        else {
+                            ring.pop();
+                        }
+                    }
+                    else {
+                        rear_future = rear << head;
+                        probe_rear_issued();
+                        ring.rear_pending = true;
+                    }
+                }
+                if (!ring.front_pending && ring.count < Depth) {
+                    front_issue();
+                    probe_front_issued();
+                    ring.front_pending = true;
+                }
+                futures[index++] = ring.front_pending ? std::addressof<future>(front_future) : nullptr;
+                futures[index++] = ring.rear_pending ? std::addressof(rear_future) : nullptr;
+            }
+
+            template <typename ErrorHandler>
+            inline void depth_process(int local, ErrorHandler& errorHandler) {
+                if (local == 0) {
+                    ring.front_pending = false;
+                    probe_front_settled(!front_future.getErr(), 1, (ring.head + ring.count) % Depth);
+                    if (front_future.getErr()) {
+                        if constexpr (std::is_same_v<ErrorHandler, std::monostate> == false) {
+                            errorHandler(pair_sum() - 1, true, front_future.getErr());
+                        }
+                    }
+                    else {
+                        ring.slots[(ring.head + ring.count) % Depth].emplace(std::move(front_future.data));
+                        ring.count++;
+                    }
+                }
+                else {
+                    ring.rear_pending = false;
+                    probe_rear_settled(!rear_future.getErr(), 1, ring.head);
+                    if (rear_future.getErr()) {
+                        if constexpr (std::is_same_v<ErrorHandler, std::monostate> == false) {
+                            errorHandler(pair_sum() - 1, false, rear_future.getErr());
+                        }
+                    }
+                    ring.pop();
+                }
+            }
+
+            // batch: one round trip moves every item the front has ready.
+            template <size_t N>
+            inline void batch_await_get(std::array<future*, N>& futures, size_t& index) {
+                if (turn == 0) {
+                    front_issue();
+                    probe_front_issued();
+                    turn = 1;
+                }
+                futures[index++] = turn == 3 ? std::addressof(rear_future) : std::addressof<future>(front_future);
+            }
+
+            template <typename ErrorHandler>
+            inline void batch_process(ErrorHandler& errorHandler) {
+                using out_t = typename trait::is_output_prot_gen<std::remove_reference_t<Front>>::prot_output_type;
+                if (turn == 1) {
+                    probe_front_settled(!front_future.getErr(), front_future.data.size());
+                    if (front_future.getErr()) {
+                        if constexpr (std::is_same_v<ErrorHandler, std::monostate> == false) {
+                            errorHandler(pair_sum() - 1, true, front_future.getErr());
+                        }
+                        turn = 0;
+                    }
+                    else if (front_future.data.empty()) {
+                        turn = 0;
+                    }
+                    else if constexpr (trait::is_batch_input_prot<std::remove_reference_t<Rear>, out_t>::await) {
+                        rear_future = rear << std::span<out_t>(front_future.data);
+                        probe_rear_issued(front_future.data.size());
+                        turn = 3;
+                    }
+                    else {
+                        rear << std::span<out_t>(front_future.data);
+                        probe_rear_done(front_future.data.size());
+                        turn = 0;
+                    }
+                }
+                else if (turn == 3) {
+                    probe_rear_settled(!rear_future.getErr(), front_future.data.size());
+                    if (rear_future.getErr()) {
+                        if constexpr (std::is_same_v<ErrorHandler, std::monostate> == false) {
+                            errorHandler(pair_sum() - 1, false, rear_future.getErr());
+                        }
+                    }
+                    turn = 0;
+                }
+                else {
+                    IO_ASSERT(false, "pipeline ERROR: unexcepted turn clock!");
+                }
+            }
+
             // Constructor for pipeline with front and rear protocols (no adaptor)
             template <typename F, typename R>
             inline pipeline(F&& f, R&& r)
@@ -365,30 +714,66 @@ namespace io {
             Rear rear;
             [[no_unique_address]] std::conditional_t<std::is_void_v<Adaptor>,
                 std::monostate, Adaptor> adaptor;
-            std::conditional_t<
+            // a batch segment reuses the vector of front_future, its capacity is kept between turns
+            std::conditional_t<batch,
+                trait::detail::movable_future_with<std::vector<typename trait::is_output_prot_gen<
+                std::remove_reference_t<Front>>::prot_output_type>>,
+                std::conditional_t<
                 trait::is_output_prot_gen<std::remove_reference_t<Front>>::await,
                 trait::detail::movable_future_with<typename trait::is_output_prot_gen<
                 std::remove_reference_t<Front>>::prot_output_type>,
                 typename trait::is_output_prot_gen<
-                std::remove_reference_t<Front>>::prot_output_type>
+                std::remove_reference_t<Front>>::prot_output_type>>
                 front_future;
             [[no_unique_address]] std::conditional_t<
                 trait::is_input_prot<
                 std::remove_reference_t<Rear>,
                 typename trait::is_output_prot_gen<
                 std::remove_reference_t<Front>>::prot_output_type,
-                Adaptor>::await,
+                Adaptor>::await || batch,
                 future, std::monostate> rear_future;
             int turn = 0; // 0 front before operator<<,1 front after operator<<, 2 rear
             // before operator>>, 3 rear after operator>>
+
+            // Items are moved out of front_future, so they must not point into memory the front protocol reuses.
+            struct depth_ring {
+                std::array<std::optional<typename trait::is_output_prot_gen<
+                    std::remove_reference_t<Front>>::prot_output_type>, Depth> slots;
+                size_t head = 0;
+                size_t count = 0;
+                bool front_pending = false;
+                bool rear_pending = false;
+                inline void pop() {
+                    slots[head].reset();
+                    head = (head + 1) % Depth;
+                    count--;
+                }
+            };
+            [[no_unique_address]] std::conditional_t<(Depth > 1), depth_ring, std::monostate> ring;
+
+            struct probe_t {
+                pipeline_stats stats;
+                uint64_t now = 0;           // clock of the current step
+                uint64_t front_since = 0;
+                uint64_t rear_since = 0;
+                std::array<uint64_t, Depth> ready_at{};     // when the items left the front, per ring position
+            };
+            [[no_unique_address]] std::conditional_t<IO_USE_PIPELINE_STATS != 0, probe_t, std::monostate> probe;
         };
 
-        template <typename Front, typename Rear, typename Adaptor>
+        template <typename Front, typename Rear, typename Adaptor, size_t Depth = 1>
         struct pipeline_constructor {
             __IO_INTERNAL_HEADER_PERMISSION;
             using Rear_t = Rear;
             using Front_t = Front;
             using Adaptor_t = Adaptor;
+            // Continue construction with in-flight depth
+            template <size_t N>
+                requires(std::is_void_v<Rear>&& std::is_void_v<Adaptor> && Depth == 1)
+            inline decltype(auto) operator>>(in_flight_t<N>)&& {
+                return pipeline_constructor<Front, void, void, N>(std::forward<Front>(front));
+            }
+
             // Continue construction with adaptor
             template <typename T>
                 requires(
@@ -402,7 +787,7 @@ namespace io {
                     std::conditional_t<
                     std::is_lvalue_reference_v<T>,
                     std::add_lvalue_reference_t<std::remove_reference_t<T>>,
-                    std::remove_reference_t<T>>>(std::forward<Front>(front),
+                    std::remove_reference_t<T>>, Depth>(std::forward<Front>(front),
                         std::forward<T>(adaptor));
             }
 
@@ -423,7 +808,7 @@ namespace io {
                     std::is_lvalue_reference_v<T>,
                     std::add_lvalue_reference_t<std::remove_reference_t<T>>,
                     std::remove_reference_t<T>>,
-                    Adaptor>(std::forward<Front>(front), std::forward<T>(rear));
+                    Adaptor, Depth>(std::forward<Front>(front), std::forward<T>(rear));
             }
 
             // Create final pipeline with input protocol and adaptor
@@ -443,7 +828,7 @@ namespace io {
                     std::is_lvalue_reference_v<T>,
                     std::add_lvalue_reference_t<std::remove_reference_t<T>>,
                     std::remove_reference_t<T>>,
-                    Adaptor>(std::forward<Front>(front), std::forward<T>(rear),
+                    Adaptor, Depth>(std::forward<Front>(front), std::forward<T>(rear),
                         std::forward<Adaptor>(adaptor));
             }
 
@@ -475,13 +860,13 @@ namespace io {
 
         public:
             // Constructor that takes ownership of a pipeline
-            template <typename Front, typename Rear, typename Adaptor>
-            explicit pipeline_started(pipeline<Front, Rear, Adaptor>&& pipe)
+            template <typename Front, typename Rear, typename Adaptor, size_t Depth>
+            explicit pipeline_started(pipeline<Front, Rear, Adaptor, Depth>&& pipe)
                 : _pipeline(std::move(pipe)) {
             }
 
-            template <typename Front, typename Rear, typename Adaptor>
-            explicit pipeline_started(pipeline<Front, Rear, Adaptor>&& pipe,
+            template <typename Front, typename Rear, typename Adaptor, size_t Depth>
+            explicit pipeline_started(pipeline<Front, Rear, Adaptor, Depth>&& pipe,
                 ErrorHandler&& e)
                 : _pipeline(std::move(pipe)),
                 errorHandler(std::forward<ErrorHandler>(e)) {
@@ -496,23 +881,65 @@ namespace io {
             pipeline_started(const pipeline_started&) = delete;
             pipeline_started& operator=(const pipeline_started&) = delete;
 
-            // Drive the pipeline with a specific index
-            inline void operator<=(int which)
+            inline ~pipeline_started() {
+                if constexpr (individual_coro == false) {
+                    for (lowlevel::awaiter* awa : ws.registered) {
+                        if (awa)
+                            awa->coro = nullptr;
+                    }
+                }
+            }
+
+            // Drive the pipeline with the next settled slot. The value from operator+ is not used.
+            inline void operator<=(int)
                 requires(individual_coro == false)
             {
+                IO_ASSERT(ws.ready_count, "pipeline ERROR: no settled segment!");
+                int slot = ws.ready[ws.ready_head];
+                ws.ready_head = (ws.ready_head + 1) % slots;
+                ws.ready_count--;
+                ws.registered[slot] = nullptr;
                 if constexpr (std::is_same_v<ErrorHandler, std::monostate>) {
-                    _pipeline.process(which, std::monostate{});
+                    _pipeline.step(slot, std::monostate{}, *this);
                 }
                 else {
-                    _pipeline.process(which, std::ref(errorHandler));
+                    _pipeline.step(slot, std::ref(errorHandler), *this);
                 }
             }
 
-            // Get the awaitable for the pipeline
-            inline decltype(auto) operator+()
+            // Get the awaitable for the pipeline: settles when a segment has settled.
+            inline lowlevel::wake_signal& operator+()
                 requires(individual_coro == false)
             {
-                return _pipeline.awaitable();
+                if (!ws.fire[0]) {
+                    for (size_t i = 0; i < slots; i++) {
+                        ws.fire[i] = [this, i](lowlevel::awaiter* awa) {
+                            awa->coro = nullptr;
+                            push(i);
+                            ws.wake.set();
+                            };
+                    }
+                    _pipeline.arm_all(*this);
+                }
+                // the same signal every turn, re-armed in place: pending while slots are queued
+                ws.wake.pending = ws.ready_count != 0;
+                return ws.wake;
+            }
+
+            // Snapshot of the counters of every segment, in pipeline order: index i is the segment
+            // after the i-th protocol, the same index the error handler gets. Needs IO_USE_PIPELINE_STATS 1.
+            inline std::array<pipeline_stats, Pipeline::pair_sum()> stats() const
+                requires(IO_USE_PIPELINE_STATS != 0)
+            {
+                std::array<pipeline_stats, Pipeline::pair_sum()> out;
+                if constexpr (individual_coro) {
+                    if (_inner)
+                        _inner->collect(out);
+                }
+                else {
+                    _pipeline.collect(out);
+                }
+                return out;
             }
 
         private:
@@ -520,12 +947,51 @@ namespace io {
             pipeline_started(pipeline_started&&) = default;
             pipeline_started& operator=(pipeline_started&&) = default;
 
+            // Wait set: a future of a segment stays registered until it settles,
+            // then its slot is queued until operator<= steps that segment.
+            static constexpr size_t slots = Pipeline::slot_sum();
+            struct wait_set {
+                std::array<std::function<void(lowlevel::awaiter*)>, slots> fire;
+                std::array<lowlevel::awaiter*, slots> registered{};    // registered or queued
+                std::array<int, slots> ready;
+                size_t ready_head = 0;
+                size_t ready_count = 0;
+                lowlevel::wake_signal wake;
+            };
+
+            // called by the segments after they issued their futures.
+            inline void add(size_t slot, future* fut) {
+                if (fut == nullptr || ws.registered[slot] == fut->awaiter)
+                    return;
+                ws.registered[slot] = fut->awaiter;
+                if (fut->awaiter->bit_set & lowlevel::awaiter::set_lock)
+                    push(slot);
+                else
+                    fut->awaiter->coro = &ws.fire[slot];
+            }
+
+            inline void push(size_t slot) {
+                ws.ready[(ws.ready_head + ws.ready_count) % slots] = (int)slot;
+                ws.ready_count++;
+            }
+
             [[no_unique_address]] std::conditional_t<individual_coro, std::monostate,
                 Pipeline> _pipeline;
             [[no_unique_address]] ErrorHandler errorHandler;
+            [[no_unique_address]] std::conditional_t<individual_coro, std::monostate,
+                wait_set> ws;
+
+            // a spawned pipeline lives in the frame of its coroutine, which this handle owns.
+            inline void set_inner(Pipeline* inner) {
+                if constexpr (IO_USE_PIPELINE_STATS && individual_coro) {
+                    _inner = inner;
+                }
+            }
+            [[no_unique_address]] std::conditional_t<IO_USE_PIPELINE_STATS && individual_coro,
+                Pipeline*, std::monostate> _inner{};
         };
 
-        template <> struct pipeline<void, void, void> {
+        template <> struct pipeline<void, void, void, 1> {
             __IO_INTERNAL_HEADER_PERMISSION;
             // Chain operator for starting the pipeline - requires output protocol
             template <typename T>
@@ -586,6 +1052,21 @@ namespace io {
                     return false;
                 }
             }
+
+            // for operator<< of a protocol: hand temp to a waiting receiver and make fut ready,
+            // or make fut wait until operator>> takes it. Returns true if temp was handed over.
+            bool send_or_wait(future& fut, manager* mngr) {
+                if (send_prom.valid() && temp.has_value()) {
+                    send_prom.resolve_later(std::move(*temp));
+                    temp.reset();
+                    mngr->make_ready_future(fut);
+                    return true;
+                }
+                else {
+                    recv_prom = mngr->make_future(fut);
+                    return false;
+                }
+            }
         };
 
         // blackhole adaptor
@@ -500,6 +500,20 @@ namespace io {
                     temp = std::move(in);
                     return this->io::chan<T>::operator<<(std::span(&temp, 1));
                 }
+
+                // Batch output protocol implementation: takes every readable element at once, waits for one only when there is none.
+                inline void operator>>(future_with<std::vector<T>>& out_future)
+                    requires (Out_buf_size == 1 && std::is_default_constructible_v<T>) {
+                    size_t count = this->readable();
+                    out_future.data.resize(count ? count : 1);
+                    out_future = this->get_and_copy(std::span(out_future.data));
+                }
+
+                // Batch input protocol implementation
+                // The elements are moved into the channel.
+                inline future operator<<(std::span<T> in) requires (Out_buf_size == 1) {
+                    return this->io::chan<T>::operator<<(in);
+                }
             };
 
             // The struct itself is not thread safe at all, only the communication is thread safe.
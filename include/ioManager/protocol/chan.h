@@ -207,6 +207,17 @@ namespace io {
             inline size_t capacity() {
                 return this->getPtr()->capacity;
             }
+            // Elements a get_and_copy takes without waiting: the buffered ones and those of the blocked senders.
+            inline size_t readable() {
+                chan_base* base = this->getPtr();
+                if (base->closed || base->status == chan_base::status_t::recv_block)
+                    return 0;
+                size_t ret = size();
+                for (auto& [prom, span] : base->waiting)
+                    if (prom.valid())
+                        ret += span.size();
+                return ret;
+            }
             //close, this will deconstruct all element in buffer, and resume all coroutines.
             inline void close() {
                 return this->getPtr()->close();
@@ -484,8 +495,7 @@ namespace io {
             };
             inline future getResolvedFuture(chan_base* base) {
                 future ret;
-                promise<> prom = base->mngr->make_future(ret);
-                prom.resolve();
+                base->mngr->make_ready_future(ret);
                 return ret;
             }
             inline future getClosedFuture(chan_base* base) {
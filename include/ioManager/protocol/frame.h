@@ -0,0 +1,428 @@
+#pragma once
+#include "../ioManager.h"
+#include <deque>
+#include <unordered_map>
+
+namespace io
+{
+    inline namespace IO_LIB_VERSION___
+    {
+        namespace prot
+        {
+            // Length-prefixed binary rpc frames, many calls multiplexed over one stream by request id.
+            // Header, 16 bytes, little-endian:
+            //      uint32 payload length
+            //      uint32 request id
+            //      uint32 method id of a request, status of a response (0 for success, std::errc otherwise)
+            //      uint8  kind (0 request, 1 response)
+            //      uint8  version (1)
+            //      uint16 reserved (0)
+            // client >> serializer >> tcp >> parser >> server >> serializer >> tcp >> parser >> client
+            namespace frame
+            {
+                constexpr size_t header_size = 16;
+                constexpr uint8_t version = 1;
+                constexpr size_t max_payload = 64 * 1024 * 1024;
+
+                enum class kind_t : uint8_t {
+                    request = 0,
+                    response = 1
+                };
+
+                struct packet {
+                    uint32_t id = 0;
+                    uint32_t method = 0;                    // method id of a request, status of a response.
+                    kind_t kind = kind_t::request;
+                    io::buf payload;
+
+                    inline uint32_t status() const { return method; }
+                };
+
+                namespace detail {
+                    inline void store32(char* p, uint32_t v) {
+                        p[0] = static_cast<char>(v);
+                        p[1] = static_cast<char>(v >> 8);
+                        p[2] = static_cast<char>(v >> 16);
+                        p[3] = static_cast<char>(v >> 24);
+                    }
+                    inline uint32_t load32(const char* p) {
+                        const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+                        return static_cast<uint32_t>(u[0]) | (static_cast<uint32_t>(u[1]) << 8) |
+                            (static_cast<uint32_t>(u[2]) << 16) | (static_cast<uint32_t>(u[3]) << 24);
+                    }
+                    // status carried by a response frame.
+                    inline uint32_t to_status(std::error_code ec) {
+                        if (!ec)
+                            return 0;
+                        if (ec.category() == std::generic_category())
+                            return static_cast<uint32_t>(ec.value());
+                        return static_cast<uint32_t>(std::errc::io_error);
+                    }
+                }
+
+                // parses a byte stream into packets. io::buf in, packet out.
+                // Not Thread safe.
+                struct parser {
+                    using prot_output_type = packet;
+
+                    template <typename T_FSM>
+                    inline parser(fsm<T_FSM>& state_machine, size_t max_ready = 1024) : parser(state_machine.getManager(), max_ready) {}
+
+                    inline parser(io::manager* _manager, size_t max_ready = 1024) : manager(_manager), max_ready(max_ready) {}
+
+                    // Output operation - implements output protocol
+                    inline void operator>>(future_with<packet>& fut) {
+                        out_prom = manager->make_future(fut, &fut.data);
+                        if (ready.size()) {
+                            out_prom.resolve(std::move(ready.front()));
+                            ready.pop_front();
+                            if (ready.size() < max_ready)
+                                in_prom.resolve_later();
+                        }
+                    }
+
+                    // Input operation - implements input protocol for io::buf
+                    inline future operator<<(io::buf& data) {
+                        future fut;
+                        promise<> prom = manager->make_future(fut);
+                        if (!parse(data)) {
+                            prom.reject(std::make_error_code(std::errc::protocol_error));
+                            return fut;
+                        }
+                        if (ready.size() && out_prom.valid()) {
+                            out_prom.resolve_later(std::move(ready.front()));
+                            ready.pop_front();
+                        }
+                        if (ready.size() < max_ready)
+                            prom.resolve();
+                        else
+                            in_prom = std::move(prom);
+                        return fut;
+                    }
+
+                    IO_MANAGER_BAN_COPY(parser);
+                    parser(parser&&) = default;
+                    parser& operator=(parser&&) = default;
+
+                private:
+                    // append complete packets of pending + data to ready. false on a malformed header.
+                    inline bool parse(io::buf& data) {
+                        const char* p = data.data();
+                        size_t n = data.size();
+                        if (pending.size()) {
+                            // complete the header, then the payload of the pending packet.
+                            if (pending.size() < header_size) {
+                                size_t take = std::min(header_size - pending.size(), n);
+                                append(pending, p, take, header_size);
+                                p += take;
+                                n -= take;
+                                if (pending.size() < header_size)
+                                    return true;
+                                if (!check(pending.data()))
+                                    return false;
+                            }
+                            size_t need = header_size + detail::load32(pending.data());
+                            size_t take = std::min(need - pending.size(), n);
+                            append(pending, p, take, need);
+                            p += take;
+                            n -= take;
+                            if (pending.size() < need)
+                                return true;
+                            emit(pending.data());
+                            pending.resize(0);
+                        }
+                        while (n >= header_size) {
+                            if (!check(p))
+                                return false;
+                            size_t len = header_size + detail::load32(p);
+                            if (n < len)
+                                break;
+                            emit(p);
+                            p += len;
+                            n -= len;
+                        }
+                        if (n)
+                            append(pending, p, n, n >= header_size ? header_size + detail::load32(p) : header_size);
+                        return true;
+                    }
+                    inline static bool check(const char* header) {
+                        return static_cast<uint8_t>(header[12]) <= static_cast<uint8_t>(kind_t::response) &&
+                            static_cast<uint8_t>(header[13]) == version &&
+                            detail::load32(header) <= max_payload;
+                    }
+                    inline void emit(const char* p) {
+                        packet& pk = ready.emplace_back();
+                        size_t len = detail::load32(p);
+                        pk.id = detail::load32(p + 4);
+                        pk.method = detail::load32(p + 8);
+                        pk.kind = static_cast<kind_t>(p[12]);
+                        if (len)
+                            pk.payload = io::buf(std::span<const char>(p + header_size, len));
+                    }
+                    // append to b, growing it to at least reserve bytes.
+                    inline static void append(io::buf& b, const char* p, size_t n, size_t reserve) {
+                        if (b.capacity() < reserve) {
+                            io::buf grown(std::max(reserve, b.capacity() * 2));
+                            if (b.size())
+                                std::memcpy(grown.data(), b.data(), b.size());
+                            grown.size_increase(b.size());
+                            b = std::move(grown);
+                        }
+                        if (n) {
+                            std::memcpy(b.data() + b.size(), p, n);
+                            b.size_increase(n);
+                        }
+                    }
+
+                    io::manager* manager;
+                    size_t max_ready;
+                    std::deque<packet> ready;
+                    io::buf pending;
+                    promise<packet> out_prom;
+                    promise<> in_prom;
+                };
+
+                // encodes packets, coalescing those sent in the same turn into one buffer. packet in, io::buf out.
+                // Not Thread safe.
+                struct serializer {
+                    using prot_output_type = io::buf;
+
+                    template <typename T_FSM>
+                    inline serializer(fsm<T_FSM>& state_machine, size_t max_buffered = 256 * 1024) : serializer(state_machine.getManager(), max_buffered) {}
+
+                    inline serializer(io::manager* _manager, size_t max_buffered = 256 * 1024) : manager(_manager), max_buffered(max_buffered) {}
+
+                    // Output operation - implements output protocol
+                    inline void operator>>(future_with<io::buf>& fut) {
+                        out_prom = manager->make_future(fut, &fut.data);
+                        if (buffered.size()) {
+                            out_prom.resolve(std::move(buffered));
+                            buffered = io::buf();
+                            in_prom.resolve_later();
+                        }
+                    }
+
+                    // Input operation - implements input protocol for packet
+                    inline future operator<<(packet& pk) {
+                        future fut;
+                        promise<> prom = manager->make_future(fut);
+                        size_t len = header_size + pk.payload.size();
+                        if (buffered.capacity() - buffered.size() < len) {
+                            io::buf grown(std::max(buffered.size() + len, std::max<size_t>(buffered.capacity() * 2, 4096)));
+                            if (buffered.size())
+                                std::memcpy(grown.data(), buffered.data(), buffered.size());
+                            grown.size_increase(buffered.size());
+                            buffered = std::move(grown);
+                        }
+                        char* p = buffered.data() + buffered.size();
+                        detail::store32(p, static_cast<uint32_t>(pk.payload.size()));
+                        detail::store32(p + 4, pk.id);
+                        detail::store32(p + 8, pk.method);
+                        p[12] = static_cast<char>(pk.kind);
+                        p[13] = static_cast<char>(version);
+                        p[14] = p[15] = 0;
+                        if (pk.payload.size())
+                            std::memcpy(p + header_size, pk.payload.data(), pk.payload.size());
+                        buffered.size_increase(len);
+
+                        if (out_prom.valid()) {
+                            out_prom.resolve_later(std::move(buffered));
+                            buffered = io::buf();
+                        }
+                        if (buffered.size() < max_buffered)
+                            prom.resolve();
+                        else
+                            in_prom = std::move(prom);
+                        return fut;
+                    }
+
+                    IO_MANAGER_BAN_COPY(serializer);
+                    serializer(serializer&&) = default;
+                    serializer& operator=(serializer&&) = default;
+
+                private:
+                    io::manager* manager;
+                    size_t max_buffered;
+                    io::buf buffered;
+                    promise<io::buf> out_prom;
+                    promise<> in_prom;
+                };
+
+                // issues calls and matches responses by request id. response packet in, request packet out.
+                // Use it as an lvalue in the pipeline, call() from any coroutine of the same manager.
+                // Not Thread safe.
+                struct client {
+                    using prot_output_type = packet;
+
+                    template <typename T_FSM>
+                    inline client(fsm<T_FSM>& state_machine) : manager(state_machine.getManager()) {}
+
+                    inline client(io::manager* _manager) : manager(_manager) {}
+
+                    // result is resolved with the response payload, or rejected with the status of the response.
+                    inline void call(uint32_t method, io::buf&& payload, future_with<io::buf>& result) {
+                        uint32_t id = next_id++;
+                        waiting.insert_or_assign(id, manager->make_future(result, &result.data));
+                        if (out_prom.valid()) {
+                            packet* pk = out_prom.resolve_later();
+                            pk->id = id;
+                            pk->method = method;
+                            pk->kind = kind_t::request;
+                            pk->payload = std::move(payload);
+                        }
+                        else {
+                            outgoing.push_back({ id, method, kind_t::request, std::move(payload) });
+                        }
+                    }
+
+                    // Output operation - implements output protocol
+                    inline void operator>>(future_with<packet>& fut) {
+                        out_prom = manager->make_future(fut, &fut.data);
+                        if (outgoing.size()) {
+                            out_prom.resolve(std::move(outgoing.front()));
+                            outgoing.pop_front();
+                        }
+                    }
+
+                    // Input operation - implements input protocol for packet
+                    inline void operator<<(packet& response) {
+                        auto it = waiting.find(response.id);
+                        if (it == waiting.end())
+                            return;
+                        if (response.status())
+                            it->second.reject_later(std::error_code(static_cast<int>(response.status()), std::generic_category()));
+                        else
+                            it->second.resolve_later(std::move(response.payload));
+                        waiting.erase(it);
+                    }
+
+                    // reject every call waiting for its response, e.g. when the connection is lost.
+                    inline void fail_all(std::error_code ec) {
+                        for (auto& [id, prom] : waiting)
+                            prom.reject_later(ec);
+                        waiting.clear();
+                        outgoing.clear();
+                    }
+
+                    // calls waiting for their responses.
+                    inline size_t pending() const { return waiting.size(); }
+
+                    IO_MANAGER_BAN_COPY(client);
+                    client(client&&) = default;
+                    client& operator=(client&&) = default;
+
+                private:
+                    io::manager* manager;
+                    uint32_t next_id = 1;
+                    std::unordered_map<uint32_t, promise<io::buf>> waiting;
+                    std::deque<packet> outgoing;
+                    promise<packet> out_prom;
+                };
+
+                // runs a handler for every request and replies as soon as it finishes, out of order.
+                // request packet in, response packet out.
+                // handler(uint32_t method, io::buf payload) returns io::future_fsm_func<io::buf> or io::buf,
+                // e.g. an io::async_rpc<uint32_t, io::buf, io::buf> keyed by method id.
+                // A rejected handler replies its error as the status. operator<< blocks when max_inflight handlers are running.
+                // Not Thread safe.
+                struct server {
+                    using prot_output_type = packet;
+
+                    template <typename T_FSM, typename F>
+                    inline server(fsm<T_FSM>& state_machine, F&& handler, size_t max_inflight = 1024)
+                        : server(state_machine.getManager(), std::forward<F>(handler), max_inflight) {
+                    }
+
+                    template <typename F>
+                    inline server(io::manager* _manager, F&& handler, size_t max_inflight = 1024)
+                        : s(std::make_unique<state>()) {
+                        IO_ASSERT(max_inflight > 0, "frame::server ERROR: max_inflight must be positive.");
+                        s->manager = _manager;
+                        s->max_inflight = max_inflight;
+                        s->launch = [h = std::forward<F>(handler)](state* s, packet& request) mutable {
+                            using result_t = std::invoke_result_t<decltype(h)&, uint32_t, io::buf&&>;
+                            if constexpr (std::is_same_v<result_t, future_fsm_func<io::buf>>) {
+                                future_fsm_handle<io::buf> task = io::spawn_now(h(request.method, std::move(request.payload)));
+                                if (task->isSet()) {
+                                    s->reply(request.id, task->getErr(), std::move(task->data));
+                                }
+                                else {
+                                    uint64_t serial = s->next_serial++;
+                                    s->running.emplace(serial, io::spawn_now(serve(s, serial, request.id, std::move(task))));
+                                }
+                            }
+                            else {
+                                s->reply(request.id, std::error_code(), h(request.method, std::move(request.payload)));
+                            }
+                        };
+                    }
+
+                    // Input operation - implements input protocol for packet
+                    inline future operator<<(packet& request) {
+                        future fut;
+                        promise<> prom = s->manager->make_future(fut);
+                        if (request.kind == kind_t::request)
+                            s->launch(s.get(), request);
+                        if (s->running.size() < s->max_inflight)
+                            prom.resolve();
+                        else
+                            s->in_prom = std::move(prom);
+                        return fut;
+                    }
+
+                    // Output operation - implements output protocol
+                    inline void operator>>(future_with<packet>& fut) {
+                        s->out_prom = s->manager->make_future(fut, &fut.data);
+                        if (s->done.size()) {
+                            s->out_prom.resolve(std::move(s->done.front()));
+                            s->done.pop_front();
+                        }
+                    }
+
+                    // handlers still running.
+                    inline size_t inflight() const { return s->running.size(); }
+
+                    IO_MANAGER_BAN_COPY(server);
+                    server(server&&) = default;
+                    server& operator=(server&&) = default;
+
+                private:
+                    struct state {
+                        io::manager* manager = nullptr;
+                        size_t max_inflight = 0;
+                        uint64_t next_serial = 0;
+                        std::function<void(state*, packet&)> launch;
+                        std::deque<packet> done;
+                        promise<packet> out_prom;
+                        promise<> in_prom;
+                        std::unordered_map<uint64_t, fsm_handle<void>> running;     // destroyed first
+
+                        inline void reply(uint32_t id, std::error_code ec, io::buf&& payload) {
+                            uint32_t status = detail::to_status(ec);
+                            if (out_prom.valid()) {
+                                packet* pk = out_prom.resolve_later();
+                                pk->id = id;
+                                pk->method = status;
+                                pk->kind = kind_t::response;
+                                pk->payload = status ? io::buf() : std::move(payload);
+                            }
+                            else {
+                                done.push_back({ id, status, kind_t::response, status ? io::buf() : std::move(payload) });
+                            }
+                        }
+                    };
+                    std::unique_ptr<state> s;
+
+                    // waits for a handler that did not finish synchronously.
+                    inline static fsm_func<void> serve(state* s, uint64_t serial, uint32_t id, future_fsm_handle<io::buf> task) {
+                        co_await *task;
+                        s->reply(id, task->getErr(), std::move(task->data));
+                        s->running.erase(serial);
+                        if (s->running.size() < s->max_inflight)
+                            s->in_prom.resolve_later();
+                    }
+                };
+            }
+        }
+    }
+}
@@ -581,7 +581,6 @@ inline int case_insensitive_compare(const char* s1, const char* s2) {
                     // Input operation - implements input protocol for io::buf
                     inline future operator<<(io::buf& data) {
                         future fut;
-                        current_request.recv_prom = manager->make_future(fut);
                         
                         // Parse the data
                         enum llhttp::llhttp_errno err = llhttp::llhttp_execute(
@@ -597,16 +596,16 @@ inline int case_insensitive_compare(const char* s1, const char* s2) {
                             }
                             if (request_complete == true) {
                                 llhttp::llhttp_reset(&parser);
-                                if (current_request.try_send<io::in_side>()) {
+                                if (current_request.send_or_wait(fut, manager)) {
                                     request_complete = false;
                                 }
                             }
                             else
                             {
-                                current_request.recv_prom.resolve();
+                                manager->make_ready_future(fut);
                             }
                         } else {
-                            current_request.recv_prom.reject(std::make_error_code(std::errc::protocol_error));
+                            manager->make_future(fut).reject(std::make_error_code(std::errc::protocol_error));
                         }
                         
                         return fut;
@@ -903,7 +902,6 @@ inline int case_insensitive_compare(const char* s1, const char* s2) {
                     inline io::future operator<<(io::buf &data)
                     {
                         future fut;
-                        current_response.recv_prom = manager->make_future(fut);
 
                         // Parse the data
                         enum llhttp::llhttp_errno err = llhttp::llhttp_execute(
@@ -923,19 +921,19 @@ inline int case_insensitive_compare(const char* s1, const char* s2) {
                             if (response_complete == true)
                             {
                                 llhttp::llhttp_reset(&parser);
-                                if (current_response.try_send<io::in_side>()) {
+                                if (current_response.send_or_wait(fut, manager)) {
                                     response_complete = false;
                                 }
                             }
                             else
                             {
-                                current_response.recv_prom.resolve();
+                                manager->make_ready_future(fut);
                             }
                         }
                         else
                         {
                             // Parsing error
-                            current_response.recv_prom.reject(std::make_error_code(std::errc::protocol_error));
+                            manager->make_future(fut).reject(std::make_error_code(std::errc::protocol_error));
                         }
 
                         return fut;
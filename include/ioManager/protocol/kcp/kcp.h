@@ -3,6 +3,7 @@
 //2025.04.28
 #pragma once
 #include "../../ioManager.h"
+#include <unordered_map>
 
 namespace io
 {
@@ -17,50 +18,215 @@ namespace io
 
             struct kcp_recv_t;
             struct kcp_send_t;
+            struct kcp_scheduler;
 
-            //kcp protocol control block
-            // Not thread safe at all.
-            struct kcp_t {
-                friend struct kcp_recv_t;
-                friend struct kcp_send_t;
-            private:
-                struct fsm_builtin {
-                    kcp_detail::ikcpcb _kcp;
+            namespace kcp_detail {
+                // State of one kcp connection, shared by kcp_t, kcp_recv_t and kcp_send_t.
+                struct session {
+                    ikcpcb _kcp;
+                    io::manager* mngr;
+                    std::shared_ptr<kcp_scheduler> scheduler;
+                    size_t heap_pos = (size_t)-1;     // position in the scheduler heap
+                    uint32_t deadline = 0;            // next ikcp_update, in scheduler ticks
                     bool has_recv_prot = false;
                     bool has_send_prot = false;
-                    inline fsm_builtin() {}
-                    inline ~fsm_builtin() {
-                        kcp_detail::ikcp_release(&_kcp);
-                    }
+                    inline session(io::manager* mngr_, uint32_t conv);
+                    inline ~session();
                 };
-                inline fsm_func<fsm_builtin> kcp_regular() {
-                    auto& fsm_user = co_await io::get_fsm;
-                    io::clock delayer;
+            }
+
+            //Drives ikcp_update of every kcp connection of one manager from a single coroutine.
+            // Connections are ordered by their ikcp_check deadline in a binary heap, one clock is armed for the earliest.
+            // Ticks are milliseconds of steady_clock, so wall clock jumps never stall or burst the connections.
+            // Also keeps a pool of output buffers for kcp_send_t.
+            // Not thread safe at all. 1 scheduler per manager, created with the first kcp_t and destroyed with the last,
+            //  both on the thread driving the manager.
+            struct kcp_scheduler {
+                friend struct kcp_detail::session;
+                friend struct kcp_send_t;
+
+                static constexpr size_t BUF_POOL_MAX = 4096;
+                static constexpr uint32_t IDLE_TICK = 1000;
+
+                // get the scheduler of the manager, create it if there is none.
+                // call it on the thread driving the manager.
+                static inline std::shared_ptr<kcp_scheduler> get(io::manager* mngr) {
+                    auto& weak = schedulers()[mngr];
+                    auto ret = weak.lock();
+                    if (ret == nullptr) {
+                        ret = std::shared_ptr<kcp_scheduler>(new kcp_scheduler(mngr));
+                        weak = ret;
+                    }
+                    return ret;
+                }
+
+                // milliseconds since the scheduler was created.
+                inline uint32_t now() const {
+                    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - base).count();
+                }
+                inline size_t size() const { return heap.size(); }
+                // count of ikcp_update calls.
+                inline size_t updates() const { return update_count; }
+                inline io::manager* getManager() const { return mngr; }
+
+                kcp_scheduler(const kcp_scheduler&) = delete;
+                kcp_scheduler& operator=(const kcp_scheduler&) = delete;
+                inline ~kcp_scheduler() {
+                    auto it = schedulers().find(mngr);
+                    if (it != schedulers().end() && it->second.expired())
+                        schedulers().erase(it);
+                }
+            private:
+                inline kcp_scheduler(io::manager* mngr_) :mngr(mngr_), base(std::chrono::steady_clock::now()) {
+                    runner = mngr->spawn_later(run());
+                }
+                // schedulers of the managers driven by this thread. An entry goes with its scheduler.
+                static inline std::unordered_map<io::manager*, std::weak_ptr<kcp_scheduler>>& schedulers() {
+                    thread_local std::unordered_map<io::manager*, std::weak_ptr<kcp_scheduler>> map;
+                    return map;
+                }
+
+                static inline bool before(uint32_t a, uint32_t b) { return (int32_t)(a - b) < 0; }
+
+                inline fsm_func<void> run() {
                     while (1)
                     {
-                        auto now = std::chrono::system_clock::now();
-                        auto duration = now.time_since_epoch();
-                        uint32_t timestamp = (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
-                        kcp_detail::ikcp_update(&fsm_user.data()->_kcp, timestamp);
-                        uint32_t delay_time = kcp_detail::ikcp_check(&fsm_user.data()->_kcp, timestamp) - timestamp;
-                        fsm_user.make_clock(delayer, std::chrono::milliseconds(delay_time));
+                        uint32_t current = now();
+                        while (heap.size() && !before(current, heap[0]->deadline))
+                        {
+                            kcp_detail::session* s = heap[0];
+                            kcp_detail::ikcp_update(&s->_kcp, current);
+                            update_count++;
+                            uint32_t next = kcp_detail::ikcp_check(&s->_kcp, current);
+                            s->deadline = before(current, next) ? next : current + 1;
+                            sift_down(0);
+                        }
+                        uint32_t delay_time = heap.size() ? heap[0]->deadline - current : IDLE_TICK;
+                        armed = current + delay_time;
+                        mngr->make_clock(delayer, std::chrono::milliseconds(delay_time), true);
                         co_await delayer;
                     }
                 }
+
+                // (re)schedule a session, wakes up the scheduler if the deadline is earlier than the armed clock.
+                inline void schedule(kcp_detail::session* s, uint32_t deadline) {
+                    if (s->heap_pos == (size_t)-1) {
+                        s->heap_pos = heap.size();
+                        heap.push_back(s);
+                        s->deadline = deadline;
+                        sift_up(s->heap_pos);
+                    }
+                    else if (before(deadline, s->deadline)) {
+                        s->deadline = deadline;
+                        sift_up(s->heap_pos);
+                    }
+                    if (heap[0] == s && before(deadline, armed))
+                        delayer.set_later();
+                }
+                inline void remove(kcp_detail::session* s) {
+                    size_t pos = s->heap_pos;
+                    if (pos == (size_t)-1)
+                        return;
+                    s->heap_pos = (size_t)-1;
+                    kcp_detail::session* last = heap.back();
+                    heap.pop_back();
+                    if (last == s)
+                        return;
+                    heap[pos] = last;
+                    last->heap_pos = pos;
+                    sift_up(pos);
+                    sift_down(last->heap_pos);
+                }
+                inline void sift_up(size_t pos) {
+                    kcp_detail::session* s = heap[pos];
+                    while (pos > 0)
+                    {
+                        size_t parent = (pos - 1) / 2;
+                        if (!before(s->deadline, heap[parent]->deadline))
+                            break;
+                        heap[pos] = heap[parent];
+                        heap[pos]->heap_pos = pos;
+                        pos = parent;
+                    }
+                    heap[pos] = s;
+                    s->heap_pos = pos;
+                }
+                inline void sift_down(size_t pos) {
+                    kcp_detail::session* s = heap[pos];
+                    size_t n = heap.size();
+                    while (1)
+                    {
+                        size_t child = pos * 2 + 1;
+                        if (child >= n)
+                            break;
+                        if (child + 1 < n && before(heap[child + 1]->deadline, heap[child]->deadline))
+                            child++;
+                        if (!before(heap[child]->deadline, s->deadline))
+                            break;
+                        heap[pos] = heap[child];
+                        heap[pos]->heap_pos = pos;
+                        pos = child;
+                    }
+                    heap[pos] = s;
+                    s->heap_pos = pos;
+                }
+
+                // output buffers
+                inline io::buf acquire(size_t capacity) {
+                    while (buf_pool.size())
+                    {
+                        io::buf b = std::move(buf_pool.back());
+                        buf_pool.pop_back();
+                        if (b.capacity() >= capacity)
+                            return b;
+                    }
+                    return io::buf(capacity);
+                }
+                inline void release(io::buf& b) {
+                    if (b.owned() && b.data() == b.owned() && buf_pool.size() < BUF_POOL_MAX) {
+                        b.resize(0);
+                        buf_pool.push_back(std::move(b));
+                    }
+                }
+
+                io::manager* mngr;
+                std::chrono::steady_clock::time_point base;
+                std::vector<kcp_detail::session*> heap;
+                std::vector<io::buf> buf_pool;
+                size_t update_count = 0;
+                uint32_t armed = 0;
+                io::clock delayer;
+                fsm_handle<void> runner;
+            };
+
+            inline kcp_detail::session::session(io::manager* mngr_, uint32_t conv) :mngr(mngr_), scheduler(kcp_scheduler::get(mngr_)) {
+                kcp_detail::ikcp_create(&_kcp, conv, nullptr);
+                scheduler->schedule(this, scheduler->now());
+            }
+            inline kcp_detail::session::~session() {
+                scheduler->remove(this);
+                kcp_detail::ikcp_release(&_kcp);
+            }
+
+            //kcp protocol control block
+            // Not thread safe at all.
+            struct kcp_t {
+                friend struct kcp_recv_t;
+                friend struct kcp_send_t;
+            private:
                 inline kcp_detail::ikcpcb* getkcp() const {
-                    return &_fsm.get()->data()->_kcp;
+                    return &_session->_kcp;
                 }
-                std::shared_ptr<fsm_handle<fsm_builtin>> _fsm;
+                std::shared_ptr<kcp_detail::session> _session;
             public:
                 template<typename T_FSM>
                 inline kcp_t(fsm<T_FSM>& fsm_user, uint32_t conv) :kcp_t(fsm_user.getManager(), conv) {}
                 inline kcp_t(io::manager* manager_, uint32_t conv) {
-                    _fsm = std::make_shared<fsm_handle<fsm_builtin>>(manager_->spawn_later(kcp_regular()));
-                    kcp_detail::ikcp_create(getkcp(), conv, nullptr);
+                    _session = std::make_shared<kcp_detail::session>(manager_, conv);
                 }
                 inline ~kcp_t() {}
 
-                inline ikcpcb* operator->() { return &_fsm.get()->data()->_kcp; }
+                inline ikcpcb* operator->() { return &_session->_kcp; }
                 inline void flush() { kcp_detail::ikcp_flush(getkcp()); }
                 inline int peeksize() const { return kcp_detail::ikcp_peeksize(getkcp()); }
                 inline int setmtu(int mtu) { return kcp_detail::ikcp_setmtu(getkcp(), mtu); }
@@ -121,7 +287,7 @@ namespace io
 
                 // Output protocol - retrieve a KCP data segment after reassembly
                 inline void operator>>(future_with<prot_output_type>& out_future) {
-                    io::manager* iomanager = _kcp_parent._fsm->getManager();
+                    io::manager* iomanager = _kcp_parent._session->mngr;
 
                     auto* kcp = _kcp_parent.getkcp();
                     
@@ -147,21 +313,23 @@ namespace io
                 }
 
                 ~kcp_recv_t() {
-                    if (_kcp_parent._fsm != nullptr)
-                        _kcp_parent._fsm.get()->data()->has_recv_prot = false;
+                    if (_kcp_parent._session != nullptr)
+                        _kcp_parent._session->has_recv_prot = false;
                 }
 
             private:
                 kcp_recv_t(kcp_t kcp_parent) : _kcp_parent(kcp_parent) {
-                    if (_kcp_parent._fsm.get()->data()->has_recv_prot)
+                    if (_kcp_parent._session->has_recv_prot)
                         IO_THROW(std::runtime_error("A receive protocol object for this KCP block already exists."));
-                    _kcp_parent._fsm.get()->data()->has_recv_prot = true;
+                    _kcp_parent._session->has_recv_prot = true;
                 }
                 kcp_t _kcp_parent;
                 promise<prot_output_type> _pending_recv_promise;
             };
 
             //kcp data -> kcp send protocol -> lowlevel data
+            // Output packets are io::buf taken from the buffer pool of kcp_scheduler,
+            // the buffer of the previous packet is given back when the next one is requested.
             // Not thread safe at all.
             struct kcp_send_t {
                 static constexpr size_t OUTPUT_QUEUE_MAX = 128;
@@ -169,7 +337,7 @@ namespace io
                 friend struct kcp_t;
 
                 // Output protocol: produces raw KCP packets (to be sent via UDP or the other socket)
-                using prot_output_type = std::string;
+                using prot_output_type = io::buf;
 
                 kcp_send_t(const kcp_send_t&) = delete;
                 kcp_send_t& operator=(const kcp_send_t&) = delete;
@@ -177,7 +345,12 @@ namespace io
                 kcp_send_t(kcp_send_t&& other) noexcept : _kcp_parent(std::move(other._kcp_parent)), 
                                                         _pending_send_promise(std::move(other._pending_send_promise)),
                                                         _pending_input_promise(std::move(other._pending_input_promise)),
-                                                        _unsent_data(std::move(other._unsent_data)) {
+                                                        _unsent_data(std::move(other._unsent_data)),
+                                                        _output_buf(std::move(other._output_buf)),
+                                                        _output_head(other._output_head),
+                                                        _output_count(other._output_count),
+                                                        auto_flush(other.auto_flush) {
+                    other._output_head = other._output_count = 0;
                     _kcp_parent.getkcp()->user = this;
                 }
 
@@ -187,6 +360,11 @@ namespace io
                         _pending_send_promise = std::move(other._pending_send_promise);
                         _pending_input_promise = std::move(other._pending_input_promise);
                         _unsent_data = std::move(other._unsent_data);
+                        _output_buf = std::move(other._output_buf);
+                        _output_head = other._output_head;
+                        _output_count = other._output_count;
+                        auto_flush = other.auto_flush;
+                        other._output_head = other._output_count = 0;
                         _kcp_parent.getkcp()->user = this;
                     }
                     return *this;
@@ -194,7 +372,7 @@ namespace io
 
                 // Input protocol - send data through KCP
                 inline future operator<<(const std::span<const char>& user_data) {
-                    io::manager* iomanager = _kcp_parent._fsm->getManager();
+                    io::manager* iomanager = _kcp_parent._session->mngr;
 
                     // Create a future to return
                     future result;
@@ -229,15 +407,18 @@ namespace io
 
                 // Output protocol - get KCP packets to be sent
                 inline void operator>>(future_with<prot_output_type>& out_future) {
-                    io::manager* iomanager = _kcp_parent._fsm->getManager();
-                    
+                    io::manager* iomanager = _kcp_parent._session->mngr;
+                    kcp_scheduler* scheduler = _kcp_parent._session->scheduler.get();
+
                     // Create promise
                     _pending_send_promise = iomanager->make_future(out_future, &out_future.data);
 
-                    if (_output_buf.size())
+                    if (_output_count)
                     {
-                        out_future.data = std::move(_output_buf.front());
-                        _output_buf.pop();
+                        scheduler->release(out_future.data);
+                        out_future.data = std::move(_output_buf[_output_head]);
+                        _output_head = (_output_head + 1) % _output_buf.size();
+                        _output_count--;
                         _pending_send_promise.resolve();
                         return;
                     }
@@ -267,10 +448,12 @@ namespace io
                 }
 
                 ~kcp_send_t() {
-                    if (_kcp_parent._fsm != nullptr)
+                    if (_kcp_parent._session != nullptr)
                     {
-                        _kcp_parent._fsm.get()->data()->has_send_prot = false;
+                        _kcp_parent._session->has_send_prot = false;
                         _kcp_parent.getkcp()->user = nullptr;
+                        for (auto& b : _output_buf)
+                            _kcp_parent._session->scheduler->release(b);
                     }
                 }
 
@@ -281,11 +464,17 @@ namespace io
                         // We'll use this in the >> operator to provide the data
                         kcp_send_t* self = static_cast<kcp_send_t*>(kcp->user);
                         if (self) {
+                            kcp_scheduler* scheduler = self->_kcp_parent._session->scheduler.get();
+                            size_t capacity = std::max<size_t>(len, kcp->mtu);
                             if (self->_pending_send_promise.valid())
                             {
-                                // Copy the data to our pending buffer
+                                // Copy the data to our pending buffer, reuse the buffer of the last packet if it fits
                                 auto* data_ptr = self->_pending_send_promise.data();
                                 if (data_ptr) {
+                                    if (data_ptr->capacity() < (size_t)len || data_ptr->data() != data_ptr->owned()) {
+                                        scheduler->release(*data_ptr);
+                                        *data_ptr = scheduler->acquire(capacity);
+                                    }
                                     data_ptr->resize(len);
                                     std::memcpy(data_ptr->data(), buf, len);
 
@@ -295,10 +484,17 @@ namespace io
                             }
                             else
                             {
-                                if (self->_output_buf.size() < OUTPUT_QUEUE_MAX)
-                                    self->_output_buf.push(std::string(buf, len));
-                                else
-                                    return -1;
+                                if (self->_output_count == self->_output_buf.size())
+                                {
+                                    if (self->_output_count >= OUTPUT_QUEUE_MAX)
+                                        return -1;
+                                    self->grow();
+                                }
+                                io::buf& b = self->_output_buf[(self->_output_head + self->_output_count) % self->_output_buf.size()];
+                                b = scheduler->acquire(capacity);
+                                b.resize(len);
+                                std::memcpy(b.data(), buf, len);
+                                self->_output_count++;
                             }
                             return len;
                         }
@@ -308,15 +504,25 @@ namespace io
                     // Store this pointer for the callback
                     _kcp_parent.getkcp()->user = this;
 
-                    if (_kcp_parent._fsm.get()->data()->has_send_prot)
+                    if (_kcp_parent._session->has_send_prot)
                         IO_THROW(std::runtime_error("A send protocol object for this KCP block already exists."));
-                    _kcp_parent._fsm.get()->data()->has_send_prot = true;
+                    _kcp_parent._session->has_send_prot = true;
+                }
+                // double the output ring, keeps the queued packets in order.
+                inline void grow() {
+                    std::vector<io::buf> bigger(_output_buf.size() ? _output_buf.size() * 2 : 4);
+                    for (size_t i = 0; i < _output_count; i++)
+                        bigger[i] = std::move(_output_buf[(_output_head + i) % _output_buf.size()]);
+                    _output_buf = std::move(bigger);
+                    _output_head = 0;
                 }
                 kcp_t _kcp_parent;
                 promise<prot_output_type> _pending_send_promise;
                 promise<void> _pending_input_promise;
                 std::string _unsent_data;  // Buffer for unsent data
-                std::queue<std::string> _output_buf;
+                std::vector<io::buf> _output_buf;   // ring of packets waiting for operator>>
+                size_t _output_head = 0;
+                size_t _output_count = 0;
                 bool auto_flush;
             };
 
@@ -0,0 +1,414 @@
+#pragma once
+#include "kcp.h"
+#include "../../socket/asio/udp.h"
+#include <deque>
+
+namespace io
+{
+    inline namespace IO_LIB_VERSION___
+    {
+        namespace prot
+        {
+            //many kcp sessions over one udp socket
+            // udp datagrams -> kcp_server -> (session, data)
+            // Sessions are keyed by (conv, endpoint) in an open-addressing hash table, created on their first packet
+            // (or by connect), and evicted after idle_timeout without incoming packets.
+            // Datagrams are drained from the socket in batches, kcp output is sent straight to the socket.
+            // Not thread safe at all.
+            struct kcp_server {
+                struct state;
+
+                struct config {
+                    int nodelay = 1, interval = 10, resend = 2, nc = 1;
+                    int sndwnd = 128, rcvwnd = 128;
+                    int mtu = 1400;
+                    bool auto_flush = true;             // flush kcp after every send
+                    bool accept = true;                 // create sessions for packets of unknown (conv, endpoint), false for clients
+                    size_t max_sessions = 65536;        // packets of new sessions are dropped above it
+                    std::chrono::milliseconds idle_timeout = std::chrono::seconds(30);
+                };
+
+                //one kcp connection of the server
+                struct session {
+                    friend struct kcp_server;
+                    friend struct state;
+                    inline uint32_t conv() const { return _conv; }
+                    inline const asio::ip::udp::endpoint& endpoint() const { return _endpoint; }
+                    // false after the session is evicted or the server is gone.
+                    inline bool alive() const { return _server != nullptr; }
+                    inline kcp_t& kcp() { return _kcp; }
+
+                    // send data to the peer, returns < 0 when the kcp send queue is full or the session is not alive.
+                    inline int send(std::span<const char> data) {
+                        if (_server == nullptr)
+                            return -1;
+                        int ret = kcp_detail::ikcp_send(_kcp.operator->(), data.data(), (int)data.size());
+                        if (ret >= 0 && _auto_flush)
+                            _kcp.flush();
+                        return ret;
+                    }
+
+                    inline session(io::manager* mngr, uint32_t conv_, const asio::ip::udp::endpoint& endpoint_)
+                        :_kcp(mngr, conv_), _conv(conv_), _endpoint(endpoint_) {}
+                    session(const session&) = delete;
+                    session& operator=(const session&) = delete;
+                private:
+                    kcp_t _kcp;
+                    uint32_t _conv;
+                    asio::ip::udp::endpoint _endpoint;
+                    state* _server = nullptr;
+                    uint64_t _hash = 0;
+                    uint32_t _last_active = 0;
+                    bool _auto_flush = true;
+                    bool _readable = false;             // in the readable queue
+                    session* _lru_prev = nullptr;       // sessions ordered by the last incoming packet
+                    session* _lru_next = nullptr;
+                };
+
+                struct message {
+                    std::shared_ptr<kcp_server::session> session;
+                    std::string data;
+                };
+
+                // Output protocol: messages reassembled by kcp
+                using prot_output_type = message;
+
+                template <typename T_FSM>
+                inline kcp_server(fsm<T_FSM>& fsm, sock::udp& socket) :kcp_server(fsm.getManager(), socket) {}
+                template <typename T_FSM>
+                inline kcp_server(fsm<T_FSM>& fsm, sock::udp& socket, const config& cfg) :kcp_server(fsm.getManager(), socket, cfg) {}
+                inline kcp_server(io::manager* mngr, sock::udp& socket) :s(std::make_unique<state>(mngr, socket, config{})) {}
+                inline kcp_server(io::manager* mngr, sock::udp& socket, const config& cfg) :s(std::make_unique<state>(mngr, socket, cfg)) {}
+                kcp_server(kcp_server&&) = default;
+                kcp_server& operator=(kcp_server&&) = default;
+
+                // Output protocol
+                inline void operator>>(future_with<message>& fut) {
+                    s->out_prom = s->mngr->make_future(fut, &fut.data);
+                    s->deliver<true>();
+                }
+
+                // Input protocol: send message.data to message.session
+                inline void operator<<(message& msg) {
+                    if (msg.session)
+                        msg.session->send(msg.data);
+                }
+
+                // open a session to a remote endpoint, as a client.
+                inline std::shared_ptr<session> connect(uint32_t conv, const asio::ip::udp::endpoint& endpoint) {
+                    uint64_t hash = state::hash_of(conv, endpoint);
+                    if (auto found = s->find(hash, conv, endpoint))
+                        return found;
+                    return s->create(hash, conv, endpoint);
+                }
+                // evict a session now.
+                inline void close(const std::shared_ptr<session>& ses) {
+                    if (ses && ses->_server == s.get())
+                        s->evict(ses.get());
+                }
+
+                inline size_t size() const { return s->count; }
+                inline size_t packets_received() const { return s->packets_in; }
+                inline size_t packets_sent() const { return s->packets_out; }
+                inline size_t packets_dropped() const { return s->packets_dropped; }
+
+                struct state {
+                    static constexpr size_t RECV_BUFFER_SIZE = 65536;
+                    static constexpr size_t MAX_DRAIN = 64;     // datagrams read per wakeup
+
+                    struct slot {
+                        uint64_t hash = 0;
+                        std::shared_ptr<session> ses;
+                    };
+
+                    io::manager* mngr;
+                    sock::udp& socket;
+                    config cfg;
+                    std::shared_ptr<kcp_scheduler> scheduler;
+                    std::vector<slot> table;            // linear probing, capacity is a power of 2
+                    size_t count = 0;
+                    session* lru_head = nullptr;
+                    session* lru_tail = nullptr;
+                    std::deque<std::shared_ptr<session>> readable;
+                    promise<message> out_prom;
+                    std::error_code closed;
+                    io::buf tx;
+                    size_t packets_in = 0, packets_out = 0, packets_dropped = 0;
+                    fsm_handle<void> receiver;
+                    fsm_handle<void> evictor;
+
+                    inline state(io::manager* mngr_, sock::udp& socket_, const config& cfg_)
+                        :mngr(mngr_), socket(socket_), cfg(cfg_), scheduler(kcp_scheduler::get(mngr_)), table(64) {
+                        receiver = mngr->spawn_later(receive());
+                        evictor = mngr->spawn_later(evict_idle());
+                    }
+                    inline ~state() {
+                        for (auto& sl : table)
+                            if (sl.ses)
+                                detach(sl.ses.get());
+                    }
+
+                    static inline uint64_t mix(uint64_t x) {
+                        x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+                        x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+                        return x ^ (x >> 31);
+                    }
+                    static inline uint64_t hash_of(uint32_t conv, const asio::ip::udp::endpoint& endpoint) {
+                        uint64_t h = ((uint64_t)conv << 16) | endpoint.port();
+                        if (endpoint.address().is_v4()) {
+                            h ^= (uint64_t)endpoint.address().to_v4().to_uint() << 32;
+                        }
+                        else {
+                            auto bytes = endpoint.address().to_v6().to_bytes();
+                            for (size_t i = 0; i < bytes.size(); i += 8) {
+                                uint64_t part;
+                                std::memcpy(&part, bytes.data() + i, 8);
+                                h = mix(h ^ part);
+                            }
+                        }
+                        return mix(h);
+                    }
+
+                    inline std::shared_ptr<session> find(uint64_t hash, uint32_t conv, const asio::ip::udp::endpoint& endpoint) {
+                        size_t mask = table.size() - 1;
+                        for (size_t i = hash & mask; table[i].ses; i = (i + 1) & mask) {
+                            if (table[i].hash == hash && table[i].ses->_conv == conv && table[i].ses->_endpoint == endpoint)
+                                return table[i].ses;
+                        }
+                        return nullptr;
+                    }
+                    inline void insert(uint64_t hash, std::shared_ptr<session>&& ses) {
+                        if ((count + 1) * 2 > table.size()) {
+                            std::vector<slot> old = std::move(table);
+                            table = std::vector<slot>(old.size() * 2);
+                            for (auto& sl : old)
+                                if (sl.ses)
+                                    place(sl.hash, std::move(sl.ses));
+                        }
+                        place(hash, std::move(ses));
+                        count++;
+                    }
+                    inline void place(uint64_t hash, std::shared_ptr<session>&& ses) {
+                        size_t mask = table.size() - 1;
+                        size_t i = hash & mask;
+                        while (table[i].ses)
+                            i = (i + 1) & mask;
+                        table[i].hash = hash;
+                        table[i].ses = std::move(ses);
+                    }
+                    // backward shift deletion, no tombstones.
+                    inline void erase(session* ses) {
+                        size_t mask = table.size() - 1;
+                        size_t i = ses->_hash & mask;
+                        while (table[i].ses.get() != ses)
+                            i = (i + 1) & mask;
+                        table[i].ses.reset();
+                        count--;
+                        for (size_t j = (i + 1) & mask; table[j].ses; j = (j + 1) & mask) {
+                            size_t home = table[j].hash & mask;
+                            if (((j - home) & mask) >= ((j - i) & mask)) {
+                                table[i] = std::move(table[j]);
+                                i = j;
+                            }
+                        }
+                    }
+
+                    inline std::shared_ptr<session> create(uint64_t hash, uint32_t conv, const asio::ip::udp::endpoint& endpoint) {
+                        auto ses = std::make_shared<session>(mngr, conv, endpoint);
+                        ses->_server = this;
+                        ses->_hash = hash;
+                        ses->_auto_flush = cfg.auto_flush;
+                        ses->_last_active = scheduler->now();
+                        ses->_kcp.nodelay(cfg.nodelay, cfg.interval, cfg.resend, cfg.nc);
+                        ses->_kcp.wndsize(cfg.sndwnd, cfg.rcvwnd);
+                        ses->_kcp.setmtu(cfg.mtu);
+                        ses->_kcp->user = ses.get();
+                        kcp_detail::ikcp_setoutput(ses->_kcp.operator->(), +[](const char* buf, int len, kcp_detail::ikcpcb* kcp, void*) -> int {
+                            session* ses = static_cast<session*>(kcp->user);
+                            if (ses == nullptr || ses->_server == nullptr)
+                                return -1;
+                            return ses->_server->output(ses, buf, len);
+                            });
+                        lru_push(ses.get());
+                        insert(hash, std::shared_ptr<session>(ses));
+                        return ses;
+                    }
+                    inline void detach(session* ses) {
+                        ses->_server = nullptr;
+                        ses->_kcp->user = nullptr;
+                    }
+                    inline void evict(session* ses) {
+                        lru_remove(ses);
+                        detach(ses);
+                        erase(ses);
+                    }
+
+                    inline void lru_push(session* ses) {
+                        ses->_lru_prev = lru_tail;
+                        ses->_lru_next = nullptr;
+                        if (lru_tail)
+                            lru_tail->_lru_next = ses;
+                        else
+                            lru_head = ses;
+                        lru_tail = ses;
+                    }
+                    inline void lru_remove(session* ses) {
+                        if (ses->_lru_prev)
+                            ses->_lru_prev->_lru_next = ses->_lru_next;
+                        else
+                            lru_head = ses->_lru_next;
+                        if (ses->_lru_next)
+                            ses->_lru_next->_lru_prev = ses->_lru_prev;
+                        else
+                            lru_tail = ses->_lru_prev;
+                    }
+
+                    inline int output(session* ses, const char* buf, int len) {
+                        std::error_code ec;
+                        packets_out++;
+                        if (socket.try_send_to(std::span<const char>(buf, len), ses->_endpoint, ec))
+                            return len;
+                        if (ec && ec != asio::error::would_block)
+                            return -1;
+                        // the socket is full, queue it in the socket
+                        if (tx.capacity() < (size_t)len)
+                            tx = io::buf(std::max<size_t>(len, cfg.mtu));
+                        tx.resize(len);
+                        std::memcpy(tx.data(), buf, len);
+                        std::pair<io::buf, asio::ip::udp::endpoint> data(std::move(tx), ses->_endpoint);
+                        socket << data;
+                        tx = std::move(data.first);
+                        return len;
+                    }
+
+                    inline void input(io::buf& datagram, const asio::ip::udp::endpoint& endpoint) {
+                        packets_in++;
+                        if (datagram.size() < 24) {
+                            packets_dropped++;
+                            return;
+                        }
+                        uint32_t conv = kcp_detail::ikcp_getconv(datagram.data());
+                        uint64_t hash = hash_of(conv, endpoint);
+                        std::shared_ptr<session> ses = find(hash, conv, endpoint);
+                        if (ses == nullptr) {
+                            if (cfg.accept == false || count >= cfg.max_sessions) {
+                                packets_dropped++;
+                                return;
+                            }
+                            ses = create(hash, conv, endpoint);
+                        }
+                        if (kcp_detail::ikcp_input(ses->_kcp.operator->(), datagram.data(), (long)datagram.size()) < 0) {
+                            packets_dropped++;
+                            return;
+                        }
+                        ses->_last_active = scheduler->now();
+                        lru_remove(ses.get());
+                        lru_push(ses.get());
+                        if (ses->_readable == false && ses->_kcp.peeksize() > 0) {
+                            ses->_readable = true;
+                            readable.push_back(std::move(ses));
+                        }
+                    }
+
+                    // move one message of the first readable session to the output future.
+                    template <bool from_output>
+                    inline bool deliver() {
+                        if (out_prom.valid() == false)
+                            return false;
+                        while (readable.size())
+                        {
+                            session* ses = readable.front().get();
+                            int size = ses->alive() ? ses->_kcp.peeksize() : -1;
+                            if (size < 0) {
+                                ses->_readable = false;
+                                readable.pop_front();
+                                continue;
+                            }
+                            message* msg = out_prom.data();
+                            msg->data.resize(size);
+                            kcp_detail::ikcp_recv(ses->_kcp.operator->(), msg->data.data(), size);
+                            msg->session = readable.front();
+                            // round robin between readable sessions
+                            if (ses->_kcp.peeksize() > 0)
+                                readable.push_back(std::move(readable.front()));
+                            else
+                                ses->_readable = false;
+                            readable.pop_front();
+                            if constexpr (from_output)
+                                out_prom.resolve();
+                            else
+                                out_prom.resolve_later();
+                            return true;
+                        }
+                        if (closed) {
+                            if constexpr (from_output)
+                                out_prom.reject(closed);
+                            else
+                                out_prom.reject_later(closed);
+                            return true;
+                        }
+                        return false;
+                    }
+
+                    inline fsm_func<void> receive() {
+                        io::buf rx(RECV_BUFFER_SIZE);
+                        asio::ip::udp::endpoint endpoint;
+                        future_with<std::pair<io::buf, asio::ip::udp::endpoint>> fut;
+                        while (1)
+                        {
+                            if (rx)
+                                socket.setNextBuf(std::move(rx));
+                            socket >> fut;
+                            co_await fut;
+                            if (fut.getErr()) {
+                                // an empty read (e.g. icmp error) keeps the socket open
+                                if (fut.getErr() != std::errc::connection_aborted) {
+                                    closed = fut.getErr();
+                                    deliver<false>();
+                                    co_return;
+                                }
+                            }
+                            else {
+                                rx = std::move(fut.data.first);
+                                input(rx, fut.data.second);
+                            }
+                            if (!rx)
+                                rx = io::buf(RECV_BUFFER_SIZE);
+
+                            // drain the socket, up to MAX_DRAIN datagrams: a flood must not starve the clocks,
+                            //  the kcp_scheduler and the other coroutines of the manager.
+                            std::error_code ec;
+                            size_t drained = 0;
+                            while (drained < MAX_DRAIN)
+                            {
+                                rx.resize(0);
+                                if (socket.try_receive_from(rx, endpoint, ec) == false)
+                                    break;
+                                input(rx, endpoint);
+                                drained++;
+                            }
+                            rx.resize(0);
+                            deliver<false>();
+                            if (drained == MAX_DRAIN)
+                                co_await io::yield;     // more may be waiting, the read is re-armed once the rest ran
+                        }
+                    }
+
+                    inline fsm_func<void> evict_idle() {
+                        io::fsm<void>& fsm = co_await io::get_fsm;
+                        uint32_t timeout = (uint32_t)cfg.idle_timeout.count();
+                        while (1)
+                        {
+                            co_await fsm.setTimeout(std::max(cfg.idle_timeout / 4, std::chrono::milliseconds(10)));
+                            uint32_t now = scheduler->now();
+                            while (lru_head && now - lru_head->_last_active > timeout)
+                                evict(lru_head);
+                        }
+                    }
+                };
+            private:
+                std::unique_ptr<state> s;
+            };
+        }
+    }
+}
@@ -109,10 +109,10 @@ namespace io
                 // Internal coroutine function, generates random data packets
                 static fsm_func<built_in> packet_generator(auto interval) {
                     fsm<built_in>& fsm = co_await io::get_fsm;
-                    io::clock delayer;
+                    io::periodic delayer;
+                    fsm.make_periodic(delayer, interval, io::periodic_mode::fixed_delay);
 
                     while (true) {
-                        fsm.make_clock(delayer, interval);
                         co_await delayer;
 
                         if (!fsm->activated || !fsm->promise.valid() || fsm->package_sum_limit < fsm->queue.size()) {
@@ -24,6 +24,17 @@ namespace io {
             template <typename F>
             def(F) -> def<typename trait::function_traits<F>::template arg<0>::type,
                 typename trait::function_traits<F>::result_type>;
+
+            // route of rpc_router: method ("*" or empty for any), pattern and handler.
+            // pattern segments: "static", ":param", "*" or "*name" (last segment only, captures the rest).
+            template <typename F> struct route {
+                std::string_view method;
+                std::string_view pattern;
+                F handler;
+            };
+
+            template <typename F>
+            route(std::string_view, std::string_view, F) -> route<F>;
         };
 
         template <typename key = void, typename req = void, typename rsp = void>
@@ -80,5 +91,428 @@ namespace io {
 
             inline void process_args() {}
         };
+
+        // rpc whose handlers are coroutines: rsp(req) becomes io::future_fsm_func<rsp>(req).
+        template <typename key, typename req, typename rsp>
+        using async_rpc = rpc<key, req, future_fsm_func<rsp>>;
+
+        // bidirectional pipeline protocol running asynchronous handlers, req in, rsp out.
+        // Many requests are in flight at the same time, responses are output in the order of requests.
+        // Handler kinds, the request is moved into the handler (take it by value in coroutines):
+        //      io::future_fsm_func<rsp>(req)                   coroutine, spawned immediately.
+        //      void(req, io::future_with<rsp>&)                fills the future, like operator>> of a protocol.
+        //      rsp(req)                                        synchronous.
+        // A rejected handler rejects its response in order. operator<< blocks when max_inflight responses are pending.
+        // Not Thread safe.
+        template <typename Req, typename Resp>
+        struct rpc_adaptor {
+            using prot_output_type = Resp;
+
+            template <typename T_FSM, typename F>
+            inline rpc_adaptor(fsm<T_FSM>& state_machine, F&& handler, size_t max_inflight = 64)
+                : rpc_adaptor(state_machine.getManager(), std::forward<F>(handler), max_inflight) {
+            }
+
+            template <typename F>
+            inline rpc_adaptor(io::manager* _manager, F&& handler, size_t max_inflight = 64)
+                : s(std::make_unique<state>()) {
+                IO_ASSERT(max_inflight > 0, "rpc_adaptor ERROR: max_inflight must be positive.");
+                s->mngr = _manager;
+                s->max_inflight = max_inflight;
+                s->launch = [h = std::forward<F>(handler), mngr = _manager](Req&& r, slot& sl) mutable {
+                    if constexpr (std::is_invocable_v<decltype(h)&, Req&&, future_with<Resp>&>) {
+                        h(std::move(r), sl.fut);
+                    }
+                    else if constexpr (std::is_same_v<std::invoke_result_t<decltype(h)&, Req&&>, future_fsm_func<Resp>>) {
+                        sl.task = io::spawn_now(h(std::move(r)));
+                    }
+                    else {
+                        mngr->make_future(sl.fut, &sl.fut.data).resolve(h(std::move(r)));
+                    }
+                };
+            }
+
+            // start the handler of a request.
+            inline future operator<<(Req& input) {
+                if (!s->collector)
+                    s->collector = io::spawn_now(collect(s.get()));
+                slot& sl = s->slots.emplace_back();
+                s->launch(std::move(input), sl);
+                if (s->slots.size() == 1) {
+                    // collector is parked on an empty queue.
+                    if (sl.result().isSet()) {
+                        s->head_done = true;
+                        s->template deliver<false>();
+                    }
+                    else {
+                        s->wake.resolve_later();
+                    }
+                }
+
+                future fut;
+                promise<void> prom = s->mngr->make_future(fut);
+                if (s->slots.size() < s->max_inflight)
+                    prom.resolve();
+                else
+                    s->in_prom = std::move(prom);
+                return fut;
+            }
+
+            // output the next response in the order of requests.
+            inline void operator>>(future_with<Resp>& fut) {
+                s->out_prom = s->mngr->make_future(fut, &fut.data);
+                if (s->template deliver<true>())
+                    s->wake.resolve_later();
+            }
+
+            // responses pending, running or not yet output.
+            inline size_t inflight() const { return s->slots.size(); }
+
+            IO_MANAGER_BAN_COPY(rpc_adaptor);
+            rpc_adaptor(rpc_adaptor&&) = default;
+            rpc_adaptor& operator=(rpc_adaptor&&) = default;
+
+        private:
+            struct slot {
+                future_with<Resp> fut;
+                future_fsm_handle<Resp> task;
+                inline future_with<Resp>& result() { return task ? *task : fut; }
+            };
+            struct state {
+                io::manager* mngr = nullptr;
+                size_t max_inflight = 0;
+                std::function<void(Req&&, slot&)> launch;
+                std::deque<slot> slots;             // in the order of requests, stable addresses
+                bool head_done = false;             // front of slots has settled
+                promise<Resp> out_prom;
+                promise<void> in_prom;
+                promise<void> wake;
+                fsm_handle<void> collector;         // destroyed first
+
+                // hand the settled front to the output. from_output: called by operator>>, the future is not awaited yet.
+                template <bool from_output>
+                inline bool deliver() {
+                    if (!head_done || !out_prom.valid())
+                        return false;
+                    future_with<Resp>& r = slots.front().result();
+                    if (std::error_code ec = r.getErr()) {
+                        if constexpr (from_output)
+                            out_prom.reject(ec);
+                        else
+                            out_prom.reject_later(ec);
+                    }
+                    else {
+                        if constexpr (from_output)
+                            out_prom.resolve(std::move(r.data));
+                        else
+                            out_prom.resolve_later(std::move(r.data));
+                    }
+                    slots.pop_front();
+                    head_done = false;
+                    in_prom.resolve_later();
+                    return true;
+                }
+            };
+            std::unique_ptr<state> s;
+
+            // waits for the front of slots, one coroutine per adaptor.
+            inline static fsm_func<void> collect(state* s) {
+                while (1) {
+                    if (s->slots.size() && !s->head_done) {
+                        co_await s->slots.front().result();
+                        s->head_done = true;
+                    }
+                    else if (!s->head_done || !s->template deliver<false>()) {
+                        // nothing in flight, or the output is not requested yet.
+                        future wake;
+                        s->wake = s->mngr->make_future(wake);
+                        co_await wake;
+                    }
+                }
+            }
+        };
+
+        // bidirectional pipeline protocol running func(In) -> Out on the threads of an io::pool, In in, Out out.
+        // Up to max_inflight items run at the same time (default: twice the threads of the pool),
+        // outputs keep the order of inputs. The manager only awaits the workers, it never blocks on them.
+        // func runs on the worker threads: it must be thread safe and must not touch this manager.
+        // An exception thrown by func (IO_EXCEPTION_ON) rejects its output in order.
+        // Not Thread safe.
+        template <typename In, typename Out>
+        struct parallel_adaptor : rpc_adaptor<In, Out> {
+            template <typename T_FSM, typename F>
+            inline parallel_adaptor(fsm<T_FSM>& state_machine, pool& workers, F&& func, size_t max_inflight = 0)
+                : parallel_adaptor(state_machine.getManager(), workers, std::forward<F>(func), max_inflight) {
+            }
+
+            template <typename F>
+            inline parallel_adaptor(io::manager* _manager, pool& workers, F&& func, size_t max_inflight = 0)
+                : rpc_adaptor<In, Out>(_manager, offload(workers, std::forward<F>(func)),
+                    max_inflight ? max_inflight : std::max<size_t>(workers.threadsInPool.size() * 2, 1)) {
+                IO_ASSERT(workers.is_running(), "parallel_adaptor ERROR: the pool has no thread.");
+            }
+
+        private:
+            template <typename F>
+            inline static auto offload(pool& workers, F&& func) {
+                return [f = std::make_shared<std::decay_t<F>>(std::forward<F>(func)), workers = &workers](In in) -> future_fsm_func<Out> {
+                    io::fsm<io::future_with<Out>>& fsm = co_await io::get_fsm;
+                    // the output is moved back into done.data on this manager
+                    auto done = workers->post(fsm.getManager(), [f](In& in) { return (*f)(std::move(in)); }, std::move(in));
+                    co_await done;
+                    if (done.getErr()) {
+                        fsm->getPromise().reject(done.getErr());
+                        co_return;
+                    }
+                    fsm->data = std::move(done.data);
+                    co_return;
+                    };
+            }
+        };
+
+        // path parameters captured by rpc_router.
+        // string_views point into the url that was routed, parameter names into the router.
+        struct route_params {
+            static constexpr size_t capacity = 8;
+            inline std::string_view operator[](std::string_view name) const {
+                for (size_t i = 0; i < count; i++) {
+                    if (items[i].first == name)
+                        return items[i].second;
+                }
+                return {};
+            }
+            inline std::string_view wildcard() const { return rest; }
+            inline size_t size() const { return count; }
+            inline auto begin() const { return items.begin(); }
+            inline auto end() const { return items.begin() + count; }
+            inline void clear() {
+                count = 0;
+                rest = {};
+            }
+
+            std::array<std::pair<std::string_view, std::string_view>, capacity> items;
+            size_t count = 0;
+            std::string_view rest;
+        };
+
+        // rpc dispatcher of radix tree, keyed by (method, url path).
+        // Static segments take precedence over ":param", and ":param" over "*". Query string and fragment are ignored.
+        // Handlers take (req, route_params&), stored in place, no heap allocation per handler.
+        // Routing allocates nothing; the tree is built when constructing, or by add().
+        // Not Thread safe.
+        template <typename req = void, typename rsp = void>
+        struct rpc_router {
+            using request_type = req;
+            using response_type = rsp;
+            using handler_type = io::inplace_function<response_type(request_type, route_params&)>;
+
+            template <typename... Args> inline rpc_router(Args &&...args) {
+                nodes_.emplace_back();
+                process_args(std::forward<Args>(args)...);
+            }
+
+            template <typename F>
+            inline void add(std::string_view method, std::string_view pattern, F&& handler) {
+                uint32_t cur = 0;
+                size_t param_count = 0;
+                std::string_view rest = trim_path(pattern);
+                while (1) {
+                    std::string_view seg = next_segment(rest);
+                    uint32_t next;
+                    if (seg.size() > 1 && (seg[0] == '*' || seg[0] == ':'))
+                        param_count++;
+                    IO_ASSERT(param_count <= route_params::capacity, "rpc_router ERROR: too many parameters in one route, see route_params::capacity.");
+                    if (seg.size() && seg[0] == '*') {
+                        IO_ASSERT(rest.empty(), "rpc_router ERROR: wildcard must be the last segment.");
+                        if (nodes_[cur].wildcard_child == npos) {
+                            next = new_node(seg.substr(1));
+                            nodes_[cur].wildcard_child = next;
+                        }
+                        next = nodes_[cur].wildcard_child;
+                    }
+                    else if (seg.size() && seg[0] == ':') {
+                        if (nodes_[cur].param_child == npos) {
+                            next = new_node(seg.substr(1));
+                            nodes_[cur].param_child = next;
+                        }
+                        next = nodes_[cur].param_child;
+                        IO_ASSERT(nodes_[next].segment == seg.substr(1),
+                            "rpc_router ERROR: conflicting parameter names on the same segment.");
+                    }
+                    else {
+                        auto& statics = nodes_[cur].statics;
+                        auto it = std::lower_bound(statics.begin(), statics.end(), seg, edge_less);
+                        if (it != statics.end() && it->segment == seg) {
+                            next = it->child;
+                        }
+                        else {
+                            size_t pos = it - statics.begin();
+                            next = new_node(seg);
+                            nodes_[cur].statics.insert(nodes_[cur].statics.begin() + pos, { nodes_[next].segment, next });
+                        }
+                    }
+                    cur = next;
+                    if (rest.data() == nullptr)
+                        break;
+                }
+                if (method == "*")
+                    method = {};
+                for (auto& [m, h] : nodes_[cur].methods) {
+                    IO_ASSERT(m != method, "rpc_router ERROR: duplicate route.");
+                }
+                nodes_[cur].methods.emplace_back(std::string(method), (uint32_t)handlers_.size());
+                handlers_.emplace_back(std::forward<F>(handler));
+            }
+
+            // find the handler of (method, url). nullptr if not found.
+            inline handler_type* find(std::string_view method, std::string_view url, route_params& params) {
+                params.clear();
+                uint32_t node = match(0, trim_path(strip_query(url)), method, params);
+                if (node == npos)
+                    return nullptr;
+                return &handlers_[handler_of(node, method)];
+            }
+
+            // Call operator to invoke the appropriate handler
+            template <typename R>
+            inline response_type operator()(std::string_view method, std::string_view url, R&& req_) {
+                route_params params;
+                handler_type* h = find(method, url, params);
+                if (h) {
+                    return (*h)(std::forward<R>(req_), params);
+                }
+                else if (default_handler_) {
+                    return default_handler_(std::forward<R>(req_), params);
+                }
+                else {
+                    IO_ASSERT(false, "rpc_router ERROR: No route matched and no default "
+                        "handler provided");
+                    return default_handler_(std::forward<R>(req_), params);
+                }
+            }
+
+            inline size_t size() const { return handlers_.size(); }
+
+        private:
+            static constexpr uint32_t npos = (uint32_t)-1;
+            struct edge {
+                std::string_view segment;
+                uint32_t child;
+            };
+            struct node {
+                std::string_view segment;                               // static text, or the name of param/wildcard
+                std::vector<edge> statics;                              // sorted by (length, text)
+                uint32_t param_child = npos;
+                uint32_t wildcard_child = npos;
+                std::vector<std::pair<std::string, uint32_t>> methods;  // empty method for any
+            };
+            std::vector<node> nodes_;
+            std::deque<std::string> segments_;                          // stable storage of node::segment
+            std::vector<handler_type> handlers_;
+            std::function<response_type(request_type, route_params&)> default_handler_;   // a std::function does not always fit in place
+
+            inline uint32_t new_node(std::string_view seg) {
+                nodes_.emplace_back();
+                nodes_.back().segment = segments_.emplace_back(seg);
+                return (uint32_t)(nodes_.size() - 1);
+            }
+            inline static std::string_view strip_query(std::string_view url) {
+                for (size_t i = 0; i < url.size(); i++) {
+                    if (url[i] == '?' || url[i] == '#')
+                        return url.substr(0, i);
+                }
+                return url;
+            }
+            inline static std::string_view trim_path(std::string_view path) {
+                if (path.size() && path[0] == '/')
+                    path.remove_prefix(1);
+                return path;
+            }
+            inline static bool edge_less(const edge& e, std::string_view s) {
+                if (e.segment.size() != s.size())
+                    return e.segment.size() < s.size();
+                return e.segment < s;
+            }
+            // pop the first segment of rest. rest.data() becomes nullptr after the last segment.
+            inline static std::string_view next_segment(std::string_view& rest) {
+                size_t pos = rest.find('/');
+                std::string_view seg;
+                if (pos == std::string_view::npos) {
+                    seg = rest;
+                    rest = std::string_view();
+                }
+                else {
+                    seg = rest.substr(0, pos);
+                    rest = rest.substr(pos + 1);
+                }
+                return seg;
+            }
+            // the handler of the method on a node, the one for any method otherwise. npos if none.
+            inline uint32_t handler_of(uint32_t node, std::string_view method) const {
+                uint32_t any = npos;
+                for (auto& [m, h] : nodes_[node].methods) {
+                    if (m == method)
+                        return h;
+                    if (m.empty())
+                        any = h;
+                }
+                return any;
+            }
+            // a node with a handler for the method. A branch without one backtracks to the next: static, ":param", then "*".
+            inline uint32_t match(uint32_t cur, std::string_view path, std::string_view method, route_params& params) {
+                std::string_view rest = path;
+                std::string_view seg = next_segment(rest);
+                const node& n = nodes_[cur];
+                auto leaf = [&](uint32_t next) -> uint32_t {
+                    if (rest.data() == nullptr)
+                        return handler_of(next, method) != npos ? next : npos;
+                    return match(next, rest, method, params);
+                };
+                if (n.statics.size()) {
+                    auto it = std::lower_bound(n.statics.begin(), n.statics.end(), seg, edge_less);
+                    if (it != n.statics.end() && it->segment == seg) {
+                        uint32_t ret = leaf(it->child);
+                        if (ret != npos)
+                            return ret;
+                    }
+                }
+                if (n.param_child != npos && seg.size() && params.count < route_params::capacity) {
+                    params.items[params.count++] = { nodes_[n.param_child].segment, seg };
+                    uint32_t ret = leaf(n.param_child);
+                    if (ret != npos)
+                        return ret;
+                    params.count--;
+                }
+                if (n.wildcard_child != npos && handler_of(n.wildcard_child, method) != npos) {
+                    params.rest = path;
+                    if (nodes_[n.wildcard_child].segment.size() && params.count < route_params::capacity)
+                        params.items[params.count++] = { nodes_[n.wildcard_child].segment, path };
+                    return n.wildcard_child;
+                }
+                return npos;
+            }
+
+            template <typename F, typename... Args>
+            inline void process_args(rpc<>::route<F> r, Args &&...args) {
+                add(r.method, r.pattern, std::move(r.handler));
+                process_args(std::forward<Args>(args)...);
+            }
+
+            template <typename Def>
+                requires(
+            std::is_same_v<Def, typename rpc<>::def<typename Def::request_type,
+                typename Def::response_type>>&&
+                std::is_convertible_v<request_type, typename Def::request_type>&&
+                std::is_convertible_v<typename Def::response_type, response_type>)
+                inline void process_args(const Def& default_handler) {
+                if (default_handler) {
+                    default_handler_ = [fn = default_handler.handler](request_type r, route_params&) mutable -> response_type {
+                        return fn(std::forward<request_type>(r));
+                    };
+                }
+            }
+
+            inline void process_args() {}
+        };
     } // namespace IO_LIB_VERSION___
 } // namespace io
\ No newline at end of file
@@ -68,9 +68,8 @@ namespace io
                 //send function
                 inline future operator <<(const std::span<char>& span) {
                     future fut;
-                    promise<> prom = manager->make_future(fut);
                     if (!asio_sock.is_open()) {
-                        prom.reject_later(std::make_error_code(std::errc::not_connected));
+                        manager->make_future(fut).reject_later(std::make_error_code(std::errc::not_connected));
                         return fut;
                     }
 
@@ -78,11 +77,12 @@ namespace io
                     std::error_code write_ec;
                     size_t bytes_written = asio_sock.write_some(asio::buffer(span.data(), span.size()), write_ec);
 
-                    // Check if we wrote everything successfully
+                    // Check if we wrote everything successfully, the future is ready without an awaiter
                     if (!write_ec && bytes_written == span.size()) {
-                        prom.resolve_later();
+                        manager->make_ready_future(fut);
                         return fut;
                     }
+                    promise<> prom = manager->make_future(fut);
 
                     // If we got an error other than would_block, reject
                     if (write_ec && write_ec != asio::error::would_block) {
@@ -105,9 +105,8 @@ namespace io
                 //send function
                 inline future operator <<(io::buf& send_buf) {
                     future fut;
-                    promise<> prom = manager->make_future(fut);
                     if (!asio_sock.is_open()) {
-                        prom.reject_later(std::make_error_code(std::errc::not_connected));
+                        manager->make_future(fut).reject_later(std::make_error_code(std::errc::not_connected));
                         return fut;
                     }
 
@@ -115,11 +114,12 @@ namespace io
                     std::error_code write_ec;
                     size_t bytes_written = asio_sock.write_some(asio::buffer(send_buf.data(), send_buf.size()), write_ec);
 
-                    // Check if we wrote everything successfully
+                    // Check if we wrote everything successfully, the future is ready without an awaiter
                     if (!write_ec && bytes_written == send_buf.size()) {
-                        prom.resolve_later();
+                        manager->make_ready_future(fut);
                         return fut;
                     }
+                    promise<> prom = manager->make_future(fut);
 
                     // If we got an error other than would_block, reject
                     if (write_ec && write_ec != asio::error::would_block) {
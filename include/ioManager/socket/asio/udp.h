@@ -194,6 +194,30 @@ namespace io
                     return fut;
                 }
 
+                // Non-blocking receive of one datagram, for draining the socket after a read wakeup.
+                // returns false with an empty ec when nothing is available.
+                inline bool try_receive_from(io::buf& read_buf, asio::ip::udp::endpoint& end, std::error_code& ec) {
+                    ec.clear();
+                    set_non_blocking(ec);
+                    size_t bytes_read = asio_sock.receive_from(asio::buffer(read_buf.unused_span().data(), read_buf.unused_span().size()), end, 0, ec);
+                    if (ec) {
+                        if (ec == asio::error::would_block)
+                            ec.clear();
+                        return false;
+                    }
+                    read_buf.size_increase(bytes_read);
+                    return true;
+                }
+
+                // Non-blocking send of one datagram without a future.
+                // returns false when the socket would block or fails, in which case ec is set.
+                inline bool try_send_to(std::span<const char> data, const asio::ip::udp::endpoint& end, std::error_code& ec) {
+                    ec.clear();
+                    set_non_blocking(ec);
+                    size_t bytes_written = asio_sock.send_to(asio::buffer(data.data(), data.size()), end, 0, ec);
+                    return !ec && bytes_written == data.size();
+                }
+
                 inline bool bind(const asio::ip::udp::endpoint& endpoint) {
                     std::error_code ec;
                     asio_sock.open(endpoint.protocol(), ec);
@@ -218,8 +242,14 @@ namespace io
                 IO_MANAGER_FORWARD_FUNC(asio_sock, native_handle);
                 IO_MANAGER_FORWARD_FUNC(asio_sock, is_open);
                 IO_MANAGER_FORWARD_FUNC(asio_sock, local_endpoint);
+                IO_MANAGER_FORWARD_FUNC(asio_sock, set_option);
 
             private:
+                // the ioctl only once: asio remembers the mode, its getter makes no syscall.
+                inline void set_non_blocking(std::error_code& ec) {
+                    if (asio_sock.non_blocking() == false)
+                        asio_sock.non_blocking(true, ec);
+                }
                 io::manager* manager = nullptr;
                 io::buf buffer;
                 asio::ip::udp::socket asio_sock;
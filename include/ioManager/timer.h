@@ -51,7 +51,7 @@ namespace io {
                 }
                 template <typename T_FSM> inline clock& await_tm(T_FSM& _fsm) {
                     auto target_time = start_tp + duration * (this->count_sum + 1);
-                    auto now = std::chrono::steady_clock::now();
+                    auto now = _fsm.getManager()->now();
 
                     bool reached = this->count() == false;
                     if (now >= target_time || reached) {
@@ -65,7 +65,7 @@ namespace io {
                 }
                 inline void reset(size_t count_sum_ = 0) {
                     counter::reset(count_sum_);
-                    start_tp = std::chrono::steady_clock::now();
+                    start_tp = io::now();
                 }
                 inline std::chrono::steady_clock::duration getDuration() const {
                     return duration;
@@ -82,9 +82,9 @@ namespace io {
             };
             // forward timer
             struct up {
-                inline void start() { previous_tp = std::chrono::steady_clock::now(); }
+                inline void start() { previous_tp = io::now(); }
                 inline std::chrono::steady_clock::duration lap() {
-                    auto now = std::chrono::steady_clock::now();
+                    auto now = io::now();
                     auto previous = previous_tp;
                     previous_tp = now;
                     if (previous_tp.time_since_epoch().count() == 0)
@@ -92,7 +92,7 @@ namespace io {
                     return now - previous;
                 }
                 inline auto elapsed() {
-                    return std::chrono::steady_clock::now() - previous_tp;
+                    return io::now() - previous_tp;
                 }
                 inline void reset() { previous_tp = {}; }
 